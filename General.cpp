@@ -5,6 +5,22 @@
  */
 
 #include "General.h"
+#include <charconv>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <new>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
 
 int support::prompt(std::string txt, std::vector<std::string> opts) {
 	// Prepare Variables
@@ -44,61 +60,278 @@ int support::prompt(std::string txt, std::vector<std::string> opts) {
 	return stoi(userInput);
 }
 
-std::vector<std::string> support::splitByDelim(std::string input) {
+support::delimSplitter::delimSplitter(std::vector<std::string> delimList) {
+	// Drop empty delims, they would never advance the split
+	for (std::string& delim : delimList)
+		if (!delim.empty())
+			delims.push_back(std::move(delim));
+
+	// Count the delims starting with each byte
+	for (const std::string& delim : delims)
+		firstByte[(unsigned char)delim[0] + 1]++;
+
+	// Turn the counts into offsets
+	for (size_t i = 1; i < firstByte.size(); i++)
+		firstByte[i] += firstByte[i - 1];
+
+	// Group the delim indices by leading byte, keeping list order within each group
+	std::array<unsigned short, 257> fill = firstByte;
+	byFirstByte.resize(delims.size());
+	for (size_t i = 0; i < delims.size(); i++)
+		byFirstByte[fill[(unsigned char)delims[i][0]]++] = i;
+}
+
+void support::delimSplitter::split(std::string_view input, std::vector<std::string_view>& parts) const {
+	// Reuse the buffer's storage
+	parts.clear();
+
+	// Start of the current part
+	size_t partStart = 0;
+
+	// The first position any delim matches is the earliest delim, ties go to the earlier delim in the list
+	for (size_t pos = 0; pos < input.size(); ) {
+		unsigned char lead = input[pos];
+		size_t matchSize = 0;
+
+		for (int i = firstByte[lead]; i < firstByte[lead + 1]; i++) {
+			const std::string& delim = delims[byFirstByte[i]];
+
+			if (input.compare(pos, delim.size(), delim) == 0) {
+				matchSize = delim.size();
+				break;
+			}
+		}
+
+		// No delim here, move on
+		if (matchSize == 0) {
+			pos++;
+			continue;
+		}
+
+		// Split the line and continue after the delim
+		parts.push_back(input.substr(partStart, pos - partStart));
+		pos += matchSize;
+		partStart = pos;
+	}
+
+	// Add the rest of the line to the return
+	parts.push_back(input.substr(partStart));
+}
+
+const support::delimSplitter& support::genericDelims() {
 	// Prepare the standard delim list
-	std::vector<std::string> delimList = { ": ", " - ", " < "," > ", "> " , " <" };
+	static const delimSplitter delims({ ": ", " - ", " < "," > ", "> " , " <" });
 
-	// Pass and return
-	return splitByDelim(input, delimList);
+	return delims;
+}
+
+std::vector<std::string> support::splitByDelim(std::string input) {
+	// Split with the standard delim list
+	std::vector<std::string_view> parts;
+	splitByDelim(input, genericDelims(), parts);
+
+	// Copy the parts out of the input
+	return std::vector<std::string>(parts.begin(), parts.end());
 }
 
 std::vector<std::string> support::splitByDelim(std::string input, std::vector<std::string> delimList) {
-	// Variables for delims found position and tracking progress
-	std::vector<int> delimPos;
-	bool isRunning = true;
-
-	// Variable for the return
-	std::vector<std::string> splitLine;
-
-	// Split until a delim cannot be found
-	while (isRunning) {
-		// Find each delim in the string
-		for (std::string delim : delimList) {
-			// Find the delim
-			int relPos = input.find(delim);
-
-			// If the delim doesn't appear, set it to the array's size
-			if (relPos == -1)
-				delimPos.push_back(input.size());
-			else
-				delimPos.push_back(input.find(delim));
-		}
+	// Split with the custom delim list
+	std::vector<std::string_view> parts;
+	splitByDelim(input, delimSplitter(std::move(delimList)), parts);
+
+	// Copy the parts out of the input
+	return std::vector<std::string>(parts.begin(), parts.end());
+}
+
+void support::splitByDelim(std::string_view input, std::vector<std::string_view>& parts) {
+	genericDelims().split(input, parts);
+}
+
+void support::splitByDelim(std::string_view input, const delimSplitter& delims, std::vector<std::string_view>& parts) {
+	delims.split(input, parts);
+}
+
+support::mappedFile::mappedFile(const std::string& path) {
+	open(path);
+}
+
+support::mappedFile::~mappedFile() {
+	close();
+}
 
-		// Determine the first delim to appear
-		auto minEleIter = std::min_element(delimPos.begin(), delimPos.end());
-		int minEle = std::distance(delimPos.begin(), minEleIter);
+bool support::mappedFile::open(const std::string& path) {
+	// Release any previous mapping
+	close();
+
+#ifdef _WIN32
+	// Open the file and read its size
+	HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (file == INVALID_HANDLE_VALUE)
+		return false;
+
+	LARGE_INTEGER fileSize;
+	if (!GetFileSizeEx(file, &fileSize)) {
+		CloseHandle(file);
+		return false;
+	}
+
+	// Empty files cannot be mapped, but are still valid
+	if (fileSize.QuadPart == 0) {
+		CloseHandle(file);
+		return true;
+	}
 
-		// If no delim's appeared, break
-		if (delimPos[minEle] == input.size()) {
-			isRunning = false;
-			break;
+	// Map the whole file, the view outlives both handles
+	HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	CloseHandle(file);
+	if (mapping == nullptr)
+		return false;
+
+	void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+	CloseHandle(mapping);
+	if (view == nullptr)
+		return false;
+
+	size_t mappedSize = fileSize.QuadPart;
+#else
+	// Open the file and read its size
+	int file = ::open(path.c_str(), O_RDONLY);
+	if (file == -1)
+		return false;
+
+	struct stat fileStat;
+	if (fstat(file, &fileStat) == -1) {
+		::close(file);
+		return false;
+	}
+
+	// Empty files cannot be mapped, but are still valid
+	if (fileStat.st_size == 0) {
+		::close(file);
+		return true;
+	}
+
+	// Map the whole file, the view outlives the descriptor
+	void* view = mmap(nullptr, fileStat.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+	::close(file);
+	if (view == MAP_FAILED)
+		return false;
+
+	size_t mappedSize = fileStat.st_size;
+#endif
+
+	// Record the mapping
+	data = static_cast<const char*>(view);
+	size = mappedSize;
+
+	return true;
+}
+
+void support::mappedFile::close() {
+	// Nothing to release
+	if (data == nullptr)
+		return;
+
+#ifdef _WIN32
+	UnmapViewOfFile(data);
+#else
+	munmap(const_cast<char*>(data), size);
+#endif
+
+	data = nullptr;
+	size = 0;
+}
+
+support::lineReader::lineReader(const std::string& path, size_t chunkSize)
+	: file(path, std::ios::binary), buffer(std::max<size_t>(chunkSize, 1)) {
+	// Note the size for estimates, an unreadable file reads as empty
+	if (file.seekg(0, std::ios::end))
+		fileSize = file.tellg();
+	file.seekg(0, std::ios::beg);
+	done = !file;
+}
+
+bool support::lineReader::next(std::string_view& line) {
+	while (true) {
+		// Hand out the next complete line in the buffer
+		const char* start = buffer.data() + begin;
+		const char* newline = static_cast<const char*>(memchr(start, '\n', end - begin));
+
+		if (newline != nullptr || (done && begin != end)) {
+			size_t length = newline != nullptr ? newline - start : end - begin;
+			size_t skip = newline != nullptr ? length + 1 : length;
+			line = std::string_view(start, length);
+			begin += skip;
+			used += skip;
+
+			// Drop the carriage return of a Windows line ending
+			if (!line.empty() && line.back() == '\r')
+				line.remove_suffix(1);
+
+			return true;
 		}
 
-		// Split the line and continue with the remainder
-		splitLine.push_back(input.substr(0, input.find(delimList[minEle])));
-		input = input.substr(input.find(delimList[minEle]) + delimList[minEle].size());
+		if (done)
+			return false;
+
+		// Move the partial line to the front, growing the buffer for a line longer than a chunk
+		memmove(buffer.data(), buffer.data() + begin, end - begin);
+		end -= begin;
+		begin = 0;
+
+		if (end == buffer.size())
+			buffer.resize(buffer.size() * 2);
 
-		// Clear the delim positions
-		delimPos.clear();
+		// Read the next chunk
+		file.read(buffer.data() + end, buffer.size() - end);
+		end += file.gcount();
+		done = !file;
 	}
+}
 
-	// Add the rest of the line to the return
-	splitLine.push_back(input);
+support::outputSink::outputSink(std::ostream& out, size_t blockSize) : out(&out), blockSize(std::max<size_t>(blockSize, 1)) {
+	buffer.reserve(this->blockSize);
+}
+
+support::outputSink::~outputSink() {
+	flush();
+}
+
+support::outputSink& support::outputSink::operator<<(std::string_view text) {
+	buffer.append(text);
+
+	// Write once a full block is buffered
+	if (buffer.size() >= blockSize)
+		flush();
+
+	return *this;
+}
+
+support::outputSink& support::outputSink::operator<<(char text) {
+	return *this << std::string_view(&text, 1);
+}
+
+support::outputSink& support::outputSink::operator<<(int value) {
+	char digits[16];
+	return *this << std::string_view(digits, std::to_chars(digits, digits + sizeof(digits), value).ptr - digits);
+}
+
+support::outputSink& support::outputSink::operator<<(double value) {
+	// Match the stream's default six significant digits
+	char digits[32];
+	int length = snprintf(digits, sizeof(digits), "%g", value);
+	return *this << std::string_view(digits, length);
+}
+
+void support::outputSink::flush() {
+	if (out == nullptr || buffer.empty())
+		return;
 
-	return splitLine;
+	out->write(buffer.data(), buffer.size());
+	buffer.clear();
 }
 
-int simpleFind::find(const std::vector<std::string>& arr, const std::string& val) {
+int simpleFind::find(const std::vector<std::string>& arr, std::string_view val) {
 	// Try to find val
 	auto loc = find(arr.begin(), arr.end(), val);
 
@@ -6,21 +6,124 @@
 
 #pragma once
 #include <string>
+#include <string_view>
 #include <vector>
+#include <array>
+#include <cstdint>
 #include <iostream>
+#include <fstream>
 #include <algorithm>
+#include <memory_resource>
 
 namespace support {
 	// Prompt for user input from a list of options
 	int prompt(std::string txt, std::vector<std::string> opts);
 
+	// Precompiled list of delims, split in a single pass over the input
+	class delimSplitter {
+	public:
+		explicit delimSplitter(std::vector<std::string> delimList);
+
+		// Split a string into views of the input, reusing the parts buffer
+		void split(std::string_view input, std::vector<std::string_view>& parts) const;
+
+	private:
+		std::vector<std::string> delims;
+
+		// Delim indices grouped by leading byte, in list order
+		std::array<unsigned short, 257> firstByte = {};
+		std::vector<unsigned short> byFirstByte;
+	};
+
+	// The generic list of delims
+	const delimSplitter& genericDelims();
+
 	// Split a string based on a generic list of delims
 	std::vector<std::string> splitByDelim(std::string input);
 	// Split a string based on a custom list of delims
 	std::vector<std::string> splitByDelim(std::string input, std::vector<std::string> delimList);
+	// Split a string into views based on a generic list of delims, reusing the parts buffer
+	void splitByDelim(std::string_view input, std::vector<std::string_view>& parts);
+	// Split a string into views based on a precompiled list of delims, reusing the parts buffer
+	void splitByDelim(std::string_view input, const delimSplitter& delims, std::vector<std::string_view>& parts);
+
+	// Read-only view of a whole file mapped into memory
+	class mappedFile {
+	public:
+		mappedFile() = default;
+		explicit mappedFile(const std::string& path);
+		~mappedFile();
+
+		mappedFile(const mappedFile&) = delete;
+		mappedFile& operator=(const mappedFile&) = delete;
+
+		// Map a file, replacing any current mapping
+		bool open(const std::string& path);
+		// Release the current mapping
+		void close();
+
+		// View the mapped contents
+		std::string_view view() const { return std::string_view(data, size); }
+
+	private:
+		const char* data = nullptr;
+		size_t size = 0;
+	};
+
+	// Reader handing out a file's lines from a fixed-size chunk buffer
+	class lineReader {
+	public:
+		explicit lineReader(const std::string& path, size_t chunkSize = 1 << 20);
+
+		// Read the next line, matching getline's splitting, false once the file is done
+		// The line stays valid until the next call
+		bool next(std::string_view& line);
+
+		// Size of the file and the bytes handed out so far
+		uint64_t size() const { return fileSize; }
+		uint64_t consumed() const { return used; }
+
+	private:
+		std::ifstream file;
+		std::vector<char> buffer;
+		size_t begin = 0, end = 0;
+		uint64_t fileSize = 0, used = 0;
+		bool done = false;
+	};
+
+	// Sink formatting text into a growable buffer, written to a stream in large blocks
+	class outputSink {
+	public:
+		explicit outputSink(std::ostream& out, size_t blockSize = 1 << 16);
+		// Buffer everything without a stream, for text written out later
+		outputSink() = default;
+		// Write whatever is still buffered
+		~outputSink();
+
+		outputSink(const outputSink&) = delete;
+		outputSink& operator=(const outputSink&) = delete;
+
+		// Append text or a number, formatted as the stream would format it
+		outputSink& operator<<(std::string_view text);
+		outputSink& operator<<(const std::string& text) { return *this << std::string_view(text); }
+		outputSink& operator<<(const char* text) { return *this << std::string_view(text); }
+		outputSink& operator<<(char text);
+		outputSink& operator<<(int value);
+		outputSink& operator<<(double value);
+
+		// Write the buffer to the stream
+		void flush();
+		// Take the buffered text, leaving the buffer empty
+		std::string take() { std::string text; text.swap(buffer); return text; }
+
+	private:
+		std::ostream* out = nullptr;
+		std::string buffer;
+		size_t blockSize = SIZE_MAX;
+	};
 }
 
 namespace simpleFind {
-	int find(const std::vector<std::string>& arr, const std::string& val);
+	int find(const std::vector<std::string>& arr, std::string_view val);
 	int find(const std::string& val, const std::vector<std::string>& arr);
 }
\ No newline at end of file
@@ -10,15 +10,45 @@
 using namespace std;
 namespace fs = filesystem;
 
-// Pull character and group information
-void startUp(vector<unit>& unitList, vector<character>& charList, vector<string>& history) {
+// Arena of the shared lists' text, released after them
+std::pmr::synchronized_pool_resource RosterArena;
+
+// Shared lists
+groupList GroupList;
+characterList CharacterList;
+
+// Cached validation of the shared lists
+validationCache RosterValidation;
+
+// Hierarchy of the shared lists
+unitHierarchy RosterHierarchy;
+
+// Ancestors of the shared unit list
+unitAncestors RosterAncestors;
+
+// Unit sizes of the shared lists
+unitSizes RosterSizes;
+
+// Relation tags of the shared character list
+tagIndex RosterTags;
+
+// Rank buckets of the shared lists
+rankIndex RosterRanks;
+
+// Saved file contents of the shared lists
+saveCache RosterSaves;
+
+// Load character and group files
+void loadRoster(vector<unit>& unitList, vector<character>& charList, vector<rosterString>& history, unsigned int loadThreads) {
+    // Declare file name variables
+    vector<string> charFiles, unitFiles;
+
     // Pull `Character Files` from the `Characters` Directory
     fs::path charPath = fs::current_path() / "Characters";
 
     if (exists(charPath))
         for (const auto& entry : fs::directory_iterator(charPath))
-            // Load the character
-            input::loadChar(entry.path().filename().string(), charList, history);
+            charFiles.push_back(entry.path().filename().string());
     else
         cout << "'Characters' directory cannot be found.\n";
 
@@ -27,58 +57,97 @@ void startUp(vector<unit>& unitList, vector<character>& charList, vector<string>
 
     if (exists(unitPath))
         for (const auto& entry : fs::directory_iterator(unitPath))
-            // Load the unit
-            input::loadUnit(entry.path().filename().string(), unitList, history);
+            unitFiles.push_back(entry.path().filename().string());
     else
         cout << "'Units' directory cannot be found.\n";
 
-    // Declare variables
-    set<string> setA, setB;
+    // Sort the files so every load produces the same order
+    sort(charFiles.begin(), charFiles.end());
+    sort(unitFiles.begin(), unitFiles.end());
 
-    // Verify the units
-    setA = interactions::verifyMemberships(charList, unitList);
+    // Load the characters and units across all available threads
+    input::loadCharFiles(charFiles, charList, history, loadThreads);
+    input::loadUnitFiles(unitFiles, unitList, history, loadThreads);
+}
 
-    setA.insert(setB.begin(), setB.end());
+// Report the roster's problems, offering to refactor any missing entities
+void reportProblems(const vector<diagnostic>& diagnostics, entityStore<unit>& unitStore, entityStore<character>& charStore) {
+    const vector<unit>& unitList = unitStore.entities();
 
-    // Verify the characters
-    setB = interactions::verifyRelations(charList);
+    // Note each missing name once
+    set<string> setA, setB;
 
-    // Report any missing entities
-    for (string unitName : setA)
-        cout << "The unit " << unitName << " cannot be found\n";
+    for (const diagnostic& diag : diagnostics) {
+        if (diag.problem == diagnostic::missingUnit)
+            setA.insert(diag.value.str());
+        else if (diag.problem == diagnostic::missingCharacter)
+            setB.insert(diag.value.str());
+    }
+
+    // Report the problems
+    interactions::printProblems(diagnostics);
 
-    for (string charName : setB)
-        cout << "The character " << charName << " cannot be found\n";
+    // Report any longer membership cycles, each cut where it is listed first
+    unitAncestors scratch;
+    for (const vector<int>& loop : simpleFind::ancestors(unitList, scratch).cycles()) {
+        if (loop.size() == 1)
+            continue;
+
+        cout << "The units ";
+        for (int pos : loop)
+            cout << unitList[pos].name << " - ";
+        cout << unitList[loop.front()].name << " form a membership cycle\n";
+    }
 
     cout << "\n";
 
     // If there are missing entities
     if ((setA.size() != 0) || (setB.size() != 0)) {
-        if (support::prompt("Refactor missing entities?", { "Yes", "No" }) == 1) {
+        switch (support::prompt("Refactor missing entities?", { "Yes", "No", "From Refactor Document" })) {
+        case 1:
             // Refactor missing units
             for (string unitName : setA)
-                missingEntity::refacUnit(unitName, charList, unitList);
+                missingEntity::refacUnit(symbol(unitName), charStore, unitStore);
 
             // Refactor missing characters
             for (string charName : setB)
-                missingEntity::refacChar(charName, charList);
+                missingEntity::refacChar(symbol(charName), charStore);
+
+            // Drop every deleted entity at once
+            simpleFind::compact(charStore);
+            simpleFind::compact(unitStore);
+            break;
+        case 3:
+            // Apply every refactor listed in the document at once
+            missingEntity::refacBatch("Refactor-Document.txt", charStore, unitStore);
+            break;
         }
     }
 }
 
+// Verify character and group information
+void startUp(groupList& groups, characterList& chars) {
+    // Validate the lists, caching the results for later checks
+    reportProblems(RosterValidation.check(chars, groups, max(1u, thread::hardware_concurrency())), groups, chars);
+}
+
 // Read the parameter document
 void readParameter(std::vector<std::vector<std::string>>& tags, std::vector<std::string>& characterRanks, std::vector<std::string>& groupRanks) {
     // Access the unit markdown file
     std::ifstream inputFile;
     inputFile.open("Parameter-Document.txt");
 
-    // For each line
+    // Delims between ranks
+    static const support::delimSplitter rankDelims({ ", " });
+    static const vector<string> rankLists = { "Character Ranks", "Group Ranks" };
+
+    // For each line, split into views so only the kept text is copied
     std::string line;
-    vector<std::string> parts;
+    vector<string_view> parts, rankParts;
 
     while (getline(inputFile, line)) {
         // Divide the line in parts based on common delims
-        parts = support::splitByDelim(line);
+        support::splitByDelim(line, parts);
 
         switch (parts.size()) {
         case 1:
@@ -86,18 +155,20 @@ void readParameter(std::vector<std::vector<std::string>>& tags, std::vector<std:
             continue;
         case 2:
             // Determine if the input is a rank or a tag
-            switch (simpleFind::find(parts[0], { "Character Ranks", "Group Ranks" })) {
+            switch (simpleFind::find(rankLists, parts[0])) {
             case -1:
                 // Add to list of tags
-                tags.push_back(parts);
+                tags.push_back({ string(parts[0]), string(parts[1]) });
                 break;
             case 0:
                 // Set character ranks
-                characterRanks = support::splitByDelim(parts[1], { ", " });
+                support::splitByDelim(parts[1], rankDelims, rankParts);
+                characterRanks.assign(rankParts.begin(), rankParts.end());
                 break;
             case 1:
                 // Set group ranks
-                groupRanks = support::splitByDelim(parts[1], { ", " });
+                support::splitByDelim(parts[1], rankDelims, rankParts);
+                groupRanks.assign(rankParts.begin(), rankParts.end());
                 break;
             }
             break;
@@ -106,7 +177,10 @@ void readParameter(std::vector<std::vector<std::string>>& tags, std::vector<std:
 }
 
 // Main function for all edit functions
-void editFunc(vector<unit>& unitList, vector<character>& charList) {
+void editFunc(groupList& groups, characterList& chars) {
+    vector<unit>& unitList = groups.entities();
+    vector<character>& charList = chars.entities();
+
     // Declare variables
     bool cont = true;
     int select;
@@ -114,20 +188,28 @@ void editFunc(vector<unit>& unitList, vector<character>& charList) {
     while (cont) {
         select = support::prompt(
             "Select",
-            { "Verify Unit Size", "Add Missing Relations", "Main Menu" }
+            { "Verify Roster", "Verify Unit Size", "Add Missing Relations", "Watch Files", "Main Menu" }
         );
 
         switch (select) {
         case 1:
+            // Recheck only what changed since the last check
+            reportProblems(RosterValidation.check(chars, groups, max(1u, thread::hardware_concurrency())), groups, chars);
+            break;
+        case 2:
             // Verify the sizes of all units
             interactions::verifySizes(charList, unitList);
             cout << "\n";
             break;
-        case 2:
+        case 3:
             // Add any one-sided unit or character relations
             modifyRelations::addMissingRelations(charList, unitList);
             break;
-        case 3:
+        case 4:
+            // Reload files as they change
+            watch::watchFiles(chars, groups);
+            break;
+        case 5:
             // Break the loop
             cont = false;
             break;
@@ -140,12 +222,15 @@ void editFunc(vector<unit>& unitList, vector<character>& charList) {
 }
 
 // Main function for all print functions
-void printFunc(vector<unit>& unitList, vector<character>& charList, vector<string>& history) {
+void printFunc(vector<unit>& unitList, vector<character>& charList, vector<rosterString>& history, saveWriter& writer) {
     // Declare variables
     bool cont = true;
     int select;
 
     while (cont) {
+        // Report any saves finished in the background
+        writer.report(RosterSaves);
+
         select = support::prompt(
             "Select",
             { "Print (Screen)", "Write (File)", "Main Menu" }
@@ -156,11 +241,13 @@ void printFunc(vector<unit>& unitList, vector<character>& charList, vector<strin
         {
             // Prompt user for the desired print
             int printSelectA = support::prompt("Apply A Filter?", { "Yes", "No" });
-            int printSelectB = support::prompt("What Type Of Print?", { "Print All", "Print By Rank", "Random Full Print", "Print Multiple" });
+            int printSelectB = support::prompt("What Type Of Print?", { "Print All", "Print By Rank", "Random Full Print", "Print Multiple", "Print By Tag" });
 
-            // Create temporary copies of the list
-            vector<character> tempCharList = charList;
-            vector<unit> tempUnitList = unitList;
+            // Print the shared lists directly, copying them only to filter
+            vector<character> tempCharList;
+            vector<unit> tempUnitList;
+            const vector<character>* printChars = &charList;
+            const vector<unit>* printUnits = &unitList;
 
             // Potentially apply a filter
             if (printSelectA == 1) {
@@ -168,37 +255,47 @@ void printFunc(vector<unit>& unitList, vector<character>& charList, vector<strin
                 vector<string> unitNames;
 
                 // Append all unit names to unitNames
-                for (unit unit : unitList) {
-                    unitNames.push_back(unit.name);
+                for (const unit& unit : unitList) {
+                    unitNames.push_back(unit.name.str());
                 }
 
                 // Generate the rules
                 vector<string> rulesList = rules::genRules(unitNames);
 
-                // Filter according to the rules
+                // Filter copies according to the rules
+                tempCharList = charList;
+                tempUnitList = unitList;
                 rules::filterRules(rulesList, tempCharList, tempUnitList);
+
+                printChars = &tempCharList;
+                printUnits = &tempUnitList;
             }
 
             // Perform the specified print
             switch (printSelectB) {
             case 1:
                 // Print all characters and units
-                output::printAll(tempCharList, tempUnitList);
+                output::printAll(*printChars, *printUnits);
 
                 break;
             case 2:
                 // Print according to the ranks
-                output::printRank(tempCharList, tempUnitList);
+                output::printRank(*printChars, *printUnits);
 
                 break;
             case 3:
                 // Print according to the ranks
-                output::printFull(tempCharList, tempUnitList);
+                output::printFull(*printChars, *printUnits);
 
                 break;
             case 4:
                 // Print according to the ranks
-                output::multiPrint(tempCharList, tempUnitList);
+                output::multiPrint(*printChars, *printUnits);
+
+                break;
+            case 5:
+                // Print the relations carrying a tag
+                output::printTagged(*printChars, *printUnits);
 
                 break;
             }
@@ -208,17 +305,21 @@ void printFunc(vector<unit>& unitList, vector<character>& charList, vector<strin
         case 2:
         {
             // Prompt user for the desired write
-            int writeSelect = support::prompt("Which Write?", { "[All] Markdown", "[All] File" });
+            int writeSelect = support::prompt("Which Write?", { "[All] Markdown", "[All] File", "[All] NDJSON" });
 
             // Perform the specified write
             switch (writeSelect) {
-            case 0:
+            case 1:
                 // Write all characters and units to markdown files
-                output::logListsMD(charList, unitList, history);
+                output::logListsMD(charList, unitList, history, max(1u, thread::hardware_concurrency()));
                 break;
-            case 1:
-                // Write all characters and units to their files
-                interactions::writeToFile(charList, unitList);
+            case 2:
+                // Queue the changed characters and units to be written to their files
+                interactions::writeToFile(charList, unitList, writer);
+                break;
+            case 3:
+                // Stream all characters and units to a single NDJSON file
+                output::logListsNDJSON(charList, unitList, history);
                 break;
             }
 
@@ -242,12 +343,35 @@ int main()
     bool cont = true;
     int select;
 
-    // Run initial preparations
-    readParameter(CharacterList.tags, CharacterList.ranks, GroupList.ranks);
-    startUp(GroupList.groups, CharacterList.characters, CharacterList.other);
+    // Run initial preparations, mapping the roster image while it matches the source files
+    rosterImage image;
+    if (image.open(rosterImage::defaultPath))
+        image.load(CharacterList, GroupList);
+    else {
+        // Note the source files before reading them, so a file edited during the load leaves the image out of date
+        vector<rosterImage::sourceFile> sources = rosterImage::currentSources();
+
+        readParameter(CharacterList.tags, CharacterList.ranks, GroupList.ranks);
+        loadRoster(GroupList.entities(), CharacterList.entities(), CharacterList.other, max(1u, thread::hardware_concurrency()));
+
+        // Save an image for the next start up
+        rosterImage::write(rosterImage::defaultPath, sources, CharacterList, GroupList);
+    }
+
+    // Index the loaded names for lookups
+    CharacterList.reindex();
+    GroupList.reindex();
+
+    startUp(GroupList, CharacterList);
+
+    // Write saves in the background, a few files at a time
+    saveWriter writer(min(4u, thread::hardware_concurrency()));
 
     // Print
     while (cont) {
+        // Report any saves finished in the background
+        writer.report(RosterSaves);
+
         select = support::prompt(
             "Select",
             { "Test Current Function", "Edit Functions", "Print Functions", "Done (Exit Program)" }
@@ -269,11 +393,11 @@ int main()
             break;
         case 2:
             // Run Edit Functions
-            editFunc(GroupList.groups, CharacterList.characters);
+            editFunc(GroupList, CharacterList);
             break;
         case 3:
             // Run Print Functions
-            printFunc(GroupList.groups, CharacterList.characters, CharacterList.other);
+            printFunc(GroupList.entities(), CharacterList.entities(), CharacterList.other, writer);
             break;
         case 4:
             // End the loop
@@ -281,4 +405,8 @@ int main()
             break;
         }
     }
+
+    // Finish any saves still being written
+    writer.wait();
+    writer.report(RosterSaves);
 }
\ No newline at end of file
@@ -0,0 +1,130 @@
+#include "Tracker.h"
+
+/*
+	Unit Ancestor Scripts
+*/
+
+void unitAncestors::build(const std::vector<unit>& unitList) {
+	int count = unitList.size();
+
+	positions.clear();
+	loops.clear();
+	parents.assign(count, -1);
+	depths.assign(count, 0);
+	enter.assign(count, 0);
+	leave.assign(count, 0);
+
+	// Note the first position of each name, matching a front to back search
+	for (int i = 0; i < count; i++)
+		positions.emplace(unitList[i].name, i);
+
+	// Link each unit to the unit it belongs to
+	for (int i = 0; i < count; i++)
+		if (unitList[i].member != symbol::none)
+			parents[i] = find(unitList[i].member);
+
+	// Follow each unvisited chain, cutting any cycle it closes
+	enum walkState : uint8_t { unvisited, onPath, finished };
+	std::vector<walkState> state(count, unvisited);
+	std::vector<int> path;
+
+	for (int i = 0; i < count; i++) {
+		path.clear();
+
+		int pos = i;
+		while (pos != -1 && state[pos] == unvisited) {
+			state[pos] = onPath;
+			path.push_back(pos);
+			pos = parents[pos];
+		}
+
+		// The chain returned to a unit on this path
+		if (pos != -1 && state[pos] == onPath) {
+			std::vector<int> loop(std::find(path.begin(), path.end(), pos), path.end());
+
+			// Start the cycle from its first unit in the list and cut that unit's link
+			std::rotate(loop.begin(), std::min_element(loop.begin(), loop.end()), loop.end());
+			parents[loop.front()] = -1;
+			loops.push_back(loop);
+		}
+
+		for (int node : path)
+			state[node] = finished;
+	}
+
+	// Gather the children of each unit in compressed rows
+	std::vector<int>& offsets = childOffsets;
+	std::vector<int>& children = childList;
+	offsets.assign(count + 1, 0);
+	children.assign(count, 0);
+	for (int i = 0; i < count; i++)
+		if (parents[i] != -1)
+			offsets[parents[i] + 1]++;
+	for (int i = 0; i < count; i++)
+		offsets[i + 1] += offsets[i];
+
+	std::vector<int> fill(offsets.begin(), offsets.end() - 1);
+	for (int i = 0; i < count; i++)
+		if (parents[i] != -1)
+			children[fill[parents[i]]++] = i;
+
+	// Number the units in preorder from each root, noting depths
+	std::vector<int> stack;
+	order.clear();
+	order.reserve(count);
+
+	for (int root = 0; root < count; root++) {
+		if (parents[root] != -1)
+			continue;
+
+		stack.push_back(root);
+		while (!stack.empty()) {
+			int node = stack.back();
+			stack.pop_back();
+
+			enter[node] = order.size();
+			order.push_back(node);
+
+			for (int child = offsets[node]; child < offsets[node + 1]; child++) {
+				depths[children[child]] = depths[node] + 1;
+				stack.push_back(children[child]);
+			}
+		}
+	}
+
+	// Close each subtree's interval after its last descendant
+	std::vector<int> sizes(count, 1);
+	for (int i = order.size() - 1; i >= 0; i--) {
+		int node = order[i];
+		leave[node] = enter[node] + sizes[node] - 1;
+
+		if (parents[node] != -1)
+			sizes[parents[node]] += sizes[node];
+	}
+
+	unitCount = count;
+	built = true;
+}
+
+int unitAncestors::find(const symbol& name) const {
+	auto found = positions.find(name);
+	return found == positions.end() ? -1 : found->second;
+}
+
+std::vector<int> unitAncestors::ancestors(int position) const {
+	std::vector<int> chain;
+	chain.reserve(depths[position]);
+
+	for (int pos = parents[position]; pos != -1; pos = parents[pos])
+		chain.push_back(pos);
+
+	return chain;
+}
+
+unitAncestors::positionRange unitAncestors::children(int position) const {
+	return { childList.data() + childOffsets[position], childList.data() + childOffsets[position + 1] };
+}
+
+bool unitAncestors::isUnder(int position, int ancestor) const {
+	return position != ancestor && enter[ancestor] <= enter[position] && leave[position] <= leave[ancestor];
+}
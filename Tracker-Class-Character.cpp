@@ -4,37 +4,38 @@
 	Character Scripts
 */
 
-std::string character::output() const {
-	std::string returnStr;
-
-	returnStr += "Name: " + name + "\n";
-	//returnStr += "Rank: " + CharacterList.ranks[rank] + "\n";
-	returnStr += "Rank: " + std::to_string(rank)  + "\n";
-	returnStr += "Member: " + member + "\n";
-	for (std::string aspect : aspects)
-		returnStr += "Aspect: " + aspect + "\n";
-	for (tagFeature relation : relations) {
-		returnStr += "Relation: " + relation.returnFeat() + "\n";
+void character::output(support::outputSink& out) const {
+	out << "Name: " << name << "\n";
+	//out << "Rank: " << CharacterList.ranks[rank] << "\n";
+	out << "Rank: " << rank << "\n";
+	out << "Member: " << member << "\n";
+	for (const rosterString& aspect : aspects)
+		out << "Aspect: " << aspect << "\n";
+	for (const tagFeature& relation : relations) {
+		out << "Relation: ";
+		relation.output(out);
+		out << "\n";
 	}
-
-	return returnStr;
 }
 
-void character::addFeature(std::string featString, std::vector<std::string>& history) {
-	// Attempt to split the input string by delims
-	std::vector<std::string> feat = input::splitDelim(featString);
+void character::addFeature(std::string_view featString, std::vector<rosterString>& history) {
+	// Attempt to split the input string by delims into a reused buffer of views
+	thread_local std::vector<std::string_view> feat;
+	input::splitDelim(featString, feat);
 
 	// If the input cannot split
 	if (feat.size() == 1) {
 		// If no history has been added previously
 		if (historyIndex == -1) {
-			// Add a new history entry and note the index
+			// Add a new history entry from the character's arena and note the index
 			historyIndex = history.size();
-			history.push_back(featString + "\n");
+			history.emplace_back(featString, arena());
+			history.back() += "\n";
 		}
 		// Else add to history
 		else {
-			history[historyIndex] += featString + "\n";
+			history[historyIndex] += featString;
+			history[historyIndex] += "\n";
 		}
 	}
 	// Rank: Set the rank to [1]'s integer equivalent
@@ -47,29 +48,30 @@ void character::addFeature(std::string featString, std::vector<std::string>& his
 	}
 	// Relation: Add character name [1] to the relation array with a descriptor [END] ([2...End-1] are tags if available)
 	else if (feat[0] == "Relation") {
-		// Create a temporary feature for the relation
-		tagFeature newRelation;
+		// Create a temporary feature for the relation, from the character's arena
+		tagFeature newRelation(arena());
 
-		// Create a variable for possible tags
-		std::vector<std::string> relTags;
+		// Create a reused buffer for possible tags
+		thread_local std::vector<std::string_view> relTags;
+		static const support::delimSplitter tagDelims({ ", ", ",", " , ", " ," });
 
 		switch (feat.size()) {
 		case 1:
 			break;
 		case 2:
-			newRelation.name = feat[1];
+			newRelation.name = symbol(feat[1]);
 			newRelation.desc = "Unknown Relation";
 			break;
 		case 3:
-			newRelation.name = feat[1];
+			newRelation.name = symbol(feat[1]);
 			newRelation.desc = feat[2];
 			break;
 		default:
-			newRelation.name = feat[1];
-			relTags = input::splitDelim(feat[2], { ", ", ",", " , ", " ," });
+			newRelation.name = symbol(feat[1]);
+			input::splitDelim(feat[2], tagDelims, relTags);
 
-			for (std::string tag : relTags) {
-				newRelation.tags.push_back(tag);
+			for (std::string_view tag : relTags) {
+				newRelation.tags.emplace_back(tag);
 			}
 
 			newRelation.desc = feat.back();
@@ -77,7 +79,7 @@ void character::addFeature(std::string featString, std::vector<std::string>& his
 		}
 
 		// Push the feature into the relation array
-		relations.push_back(newRelation);
+		relations.push_back(std::move(newRelation));
 	}
 	else
 		entity::addFeature(featString);
@@ -4,27 +4,28 @@
 	Entity Scripts
 */
 
-void entity::addFeature(const std::string& featString) {
-	// Split the input string by delims
-	std::vector<std::string> feat = input::splitDelim(featString);
+void entity::addFeature(std::string_view featString) {
+	// Split the input string by delims into a reused buffer of views
+	thread_local std::vector<std::string_view> feat;
+	input::splitDelim(featString, feat);
 
 	// Name: Set the name to [1]
 	if (feat[0] == "Name") {
-		name = feat[1];
+		name = symbol(feat[1]);
 	}
 	// Member: Set the member to [1]
 	else if (feat[0] == "Member") {
-		member = feat[1];
+		member = symbol(feat[1]);
 	}
 	// Aspect: Add [1] to the aspect array
 	else if (feat[0] == "Aspect") {
-		aspects.push_back(feat[1]);
+		aspects.emplace_back(feat[1]);
 	}
 }
 
-std::string entity::feature::returnFeat() {
+std::string feature::returnFeat() {
 	// Start the string with the partner's name
-	std::string returnVal = name;
+	std::string returnVal = name.str();
 
 	// End the string with the description
 	returnVal += " - " + desc;
@@ -33,9 +34,24 @@ std::string entity::feature::returnFeat() {
 	return returnVal;
 }
 
+void entity::tagFeature::output(support::outputSink& out) const {
+	// Start with the partner's name
+	out << name;
+
+	// If the relation has tags, list them before the description
+	if (!tags.empty()) {
+		out << " <" << tags[0];
+		for (size_t i = 1; i < tags.size(); i++)
+			out << "," << tags[i];
+		out << "> " << desc;
+	}
+	else
+		out << " - " << desc;
+}
+
 std::string entity::tagFeature::returnFeat() {
 	// Start the string with the partner's name
-	std::string returnVal = name;
+	std::string returnVal = name.str();
 
 	// If the relation has tags
 	if (!tags.empty()) {
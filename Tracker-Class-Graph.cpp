@@ -0,0 +1,62 @@
+#include "Tracker.h"
+
+/*
+	Relation Graph Scripts
+*/
+
+relationGraph::relationGraph(const std::vector<character>& characterList, const std::vector<unit>& unitList) {
+	// Name every node, resolving a repeated name to its first node
+	names.reserve(characterList.size() + unitList.size());
+	for (const character& chara : characterList)
+		names.push_back(chara.name);
+	for (const unit& uni : unitList)
+		names.push_back(uni.name);
+
+	nodes.reserve(names.size());
+	for (size_t i = 0; i < names.size(); i++)
+		nodes.emplace(names[i], i);
+
+	// Resolve each character's relations into its row, units have none
+	outOffsets.assign(names.size() + 1, 0);
+	for (size_t i = 0; i < characterList.size(); i++) {
+		for (const entity::tagFeature& relation : characterList[i].relations) {
+			int target = find(relation.name);
+			if (target != -1)
+				outTargets.push_back(target);
+		}
+
+		outOffsets[i + 1] = outTargets.size();
+	}
+
+	for (size_t i = characterList.size(); i < names.size(); i++)
+		outOffsets[i + 1] = outTargets.size();
+
+	// Count each node's incoming edges
+	inOffsets.assign(names.size() + 1, 0);
+	for (int target : outTargets)
+		inOffsets[target + 1]++;
+
+	for (size_t i = 0; i < names.size(); i++)
+		inOffsets[i + 1] += inOffsets[i];
+
+	// Place each edge under its target, visiting sources in ascending order
+	std::vector<int> next(inOffsets.begin(), inOffsets.end() - 1);
+	inSources.resize(outTargets.size());
+
+	for (size_t source = 0; source < names.size(); source++)
+		for (int target : related(source))
+			inSources[next[target]++] = source;
+}
+
+int relationGraph::find(const symbol& name) const {
+	auto it = nodes.find(name);
+	return it == nodes.end() ? -1 : it->second;
+}
+
+relationGraph::nodeRange relationGraph::related(int node) const {
+	return { outTargets.data() + outOffsets[node], outTargets.data() + outOffsets[node + 1] };
+}
+
+relationGraph::nodeRange relationGraph::relatedBy(int node) const {
+	return { inSources.data() + inOffsets[node], inSources.data() + inOffsets[node + 1] };
+}
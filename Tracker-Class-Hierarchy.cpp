@@ -0,0 +1,61 @@
+#include "Tracker.h"
+
+/*
+	Unit Hierarchy Scripts
+*/
+
+void unitHierarchy::build(const std::vector<character>& characterList) {
+	characterMembers.clear();
+
+	// File every character under the unit it belongs to, in list order
+	for (size_t i = 0; i < characterList.size(); i++)
+		characterMembers[characterList[i].member].push_back(i);
+
+	characterCount = characterList.size();
+	built = true;
+}
+
+void unitHierarchy::moveCharacter(int position, const symbol& from, const symbol& to) {
+	if (built && from != to)
+		move(characterMembers, position, from, to);
+}
+
+void unitHierarchy::addCharacter(int position, const symbol& member) {
+	if (built && size_t(position) == characterCount) {
+		characterMembers[member].push_back(position);
+		characterCount++;
+	}
+}
+
+void unitHierarchy::removeCharacter(int position, const symbol& member) {
+	if (built)
+		drop(characterMembers, position, member);
+}
+
+const std::vector<int>& unitHierarchy::characters(const symbol& name) const {
+	static const std::vector<int> empty;
+
+	auto found = characterMembers.find(name);
+	return found == characterMembers.end() ? empty : found->second;
+}
+
+void unitHierarchy::move(std::unordered_map<symbol, std::vector<int>>& members, int position, const symbol& from, const symbol& to) {
+	// Remove the position from its previous unit
+	drop(members, position, from);
+
+	// Insert it into its new unit
+	std::vector<int>& list = members[to];
+	list.insert(std::lower_bound(list.begin(), list.end(), position), position);
+}
+
+void unitHierarchy::drop(std::unordered_map<symbol, std::vector<int>>& members, int position, const symbol& from) {
+	auto previous = members.find(from);
+	if (previous == members.end())
+		return;
+
+	std::vector<int>& list = previous->second;
+	auto found = std::lower_bound(list.begin(), list.end(), position);
+
+	if (found != list.end() && *found == position)
+		list.erase(found);
+}
@@ -0,0 +1,394 @@
+#include "Tracker.h"
+#include <filesystem>
+
+/*
+	Roster Image Scripts
+*/
+
+// Identifying bytes and layout version of an image
+static const char imageMagic[4] = { 'C', 'T', 'R', 'I' };
+static const uint32_t imageVersion = 3;
+
+// Size of a single element of each section
+static const size_t sectionElement[] = {
+	sizeof(rosterImage::sourceRecord),		// sources
+	sizeof(rosterImage::entityRecord),		// characters
+	sizeof(rosterImage::entityRecord),		// units
+	sizeof(rosterImage::stringRef),			// aspects
+	sizeof(rosterImage::relationRecord),	// relations
+	sizeof(rosterImage::stringRef),			// tags
+	sizeof(rosterImage::stringRef),			// history
+	sizeof(rosterImage::paramTagRecord),	// paramTags
+	sizeof(rosterImage::stringRef),			// characterRanks
+	sizeof(rosterImage::stringRef),			// groupRanks
+	sizeof(char)							// strings
+};
+
+std::vector<rosterImage::sourceFile> rosterImage::currentSources() {
+	namespace fs = std::filesystem;
+
+	// Variables
+	std::vector<sourceFile> sourceList;
+	std::error_code err;
+
+	// Record a single file
+	auto addSource = [&](const fs::path& path, const std::string& name) {
+		uint64_t size = fs::file_size(path, err);
+		int64_t modified = fs::last_write_time(path, err).time_since_epoch().count();
+		sourceList.push_back({ name, size, modified });
+	};
+
+	if (fs::exists("Parameter-Document.txt"))
+		addSource("Parameter-Document.txt", "Parameter-Document.txt");
+
+	// Record each file in both entity directories
+	for (std::string dir : { "Characters", "Units" }) {
+		if (!fs::exists(dir))
+			continue;
+
+		for (const auto& entry : fs::directory_iterator(dir))
+			addSource(entry.path(), dir + "/" + entry.path().filename().string());
+	}
+
+	// Sort so the list can be compared directly
+	std::sort(sourceList.begin(), sourceList.end(),
+		[](const sourceFile& a, const sourceFile& b) {
+			return a.path < b.path;
+		});
+
+	return sourceList;
+}
+
+template <typename T>
+const T* rosterImage::table(section sec) const {
+	return reinterpret_cast<const T*>(file.view().data() + head->offset[sec]);
+}
+
+bool rosterImage::open(const std::string& path) {
+	// Forget any previous image
+	head = nullptr;
+
+	// Map the image
+	if (!file.open(path))
+		return false;
+
+	std::string_view contents = file.view();
+
+	// Check the header
+	if (contents.size() < sizeof(header))
+		return false;
+
+	const header* fileHead = reinterpret_cast<const header*>(contents.data());
+	if (!std::equal(imageMagic, imageMagic + 4, fileHead->magic) || fileHead->version != imageVersion)
+		return false;
+
+	// Check every section lies inside the image and is aligned
+	for (int sec = 0; sec < sectionCount; sec++) {
+		if (fileHead->offset[sec] % alignof(uint64_t) != 0 || fileHead->offset[sec] > contents.size())
+			return false;
+		if (fileHead->count[sec] > (contents.size() - fileHead->offset[sec]) / sectionElement[sec])
+			return false;
+	}
+
+	head = fileHead;
+
+	// Check every record stays inside the image
+	if (!checkBounds()) {
+		head = nullptr;
+		return false;
+	}
+
+	// Compare the recorded source files against the current ones
+	std::vector<sourceFile> sourceList = currentSources();
+	const sourceRecord* recorded = table<sourceRecord>(sources);
+
+	bool current = sourceList.size() == head->count[sources];
+	for (size_t i = 0; current && i < sourceList.size(); i++) {
+		current = text(recorded[i].path) == sourceList[i].path
+			&& recorded[i].size == sourceList[i].size
+			&& recorded[i].modified == sourceList[i].modified;
+	}
+
+	// Any change falls back to reading the text files
+	if (!current) {
+		head = nullptr;
+		file.close();
+		return false;
+	}
+
+	return true;
+}
+
+bool rosterImage::checkBounds() const {
+	// Check a string reference lies inside the string pool
+	auto checkString = [&](const stringRef& ref) {
+		return uint64_t(ref.offset) + ref.size <= head->count[strings];
+	};
+
+	// Check a range lies inside a section
+	auto checkRange = [&](uint32_t begin, uint32_t count, section sec) {
+		return uint64_t(begin) + count <= head->count[sec];
+	};
+
+	// Check each plain string section
+	for (section sec : { aspects, tags, history, characterRanks, groupRanks }) {
+		const stringRef* refs = table<stringRef>(sec);
+		for (size_t i = 0; i < head->count[sec]; i++)
+			if (!checkString(refs[i]))
+				return false;
+	}
+
+	// Check the source files
+	const sourceRecord* sourceTable = table<sourceRecord>(sources);
+	for (size_t i = 0; i < head->count[sources]; i++)
+		if (!checkString(sourceTable[i].path))
+			return false;
+
+	// Check the parameter tags
+	const paramTagRecord* paramTable = table<paramTagRecord>(paramTags);
+	for (size_t i = 0; i < head->count[paramTags]; i++)
+		if (!checkString(paramTable[i].name) || !checkString(paramTable[i].desc))
+			return false;
+
+	// Check the relations
+	const relationRecord* relationTable = table<relationRecord>(relations);
+	for (size_t i = 0; i < head->count[relations]; i++) {
+		const relationRecord& rel = relationTable[i];
+		if (!checkString(rel.name) || !checkString(rel.desc) || !checkRange(rel.tagBegin, rel.tagCount, tags))
+			return false;
+	}
+
+	// Check the characters and units
+	for (auto [entities, rankSection] : { std::make_pair(characters, characterRanks), std::make_pair(units, groupRanks) }) {
+		const entityRecord* entityTable = table<entityRecord>(entities);
+		for (size_t i = 0; i < head->count[entities]; i++) {
+			const entityRecord& ent = entityTable[i];
+			if (!checkString(ent.name) || !checkString(ent.member) || !checkString(ent.source))
+				return false;
+			if (!checkRange(ent.aspectBegin, ent.aspectCount, aspects) || !checkRange(ent.relationBegin, ent.relationCount, relations))
+				return false;
+			if (ent.rank < 0 || uint64_t(ent.rank) >= std::max<uint64_t>(1, head->count[rankSection]))
+				return false;
+			if (ent.historyIndex < -1 || ent.historyIndex >= int64_t(head->count[history]))
+				return false;
+		}
+	}
+
+	return true;
+}
+
+bool rosterImage::write(const std::string& path, const std::vector<sourceFile>& sourceList, const characterList& charList, const groupList& unitList) {
+	// Variables for each section's contents
+	std::string stringPool;
+	std::vector<sourceRecord> sourceTable;
+	std::vector<entityRecord> charTable, unitTable;
+	std::vector<stringRef> aspectTable, tagTable, historyTable, charRankTable, groupRankTable;
+	std::vector<relationRecord> relationTable;
+	std::vector<paramTagRecord> paramTable;
+
+	// Add a string to the pool
+	auto addString = [&](std::string_view str) {
+		stringRef ref = { uint32_t(stringPool.size()), uint32_t(str.size()) };
+		stringPool.append(str);
+		return ref;
+	};
+
+	// Record the source files the lists were read from
+	for (const sourceFile& source : sourceList)
+		sourceTable.push_back({ addString(source.path), source.size, source.modified });
+
+	// Record an entity and its aspects
+	auto addEntity = [&](const entity& ent, int historyIndex) {
+		entityRecord record = { addString(ent.name.str()), addString(ent.member.str()), addString(ent.source.str()), ent.rank, historyIndex,
+			uint32_t(aspectTable.size()), uint32_t(ent.aspects.size()), uint32_t(relationTable.size()), 0 };
+
+		for (const rosterString& aspect : ent.aspects)
+			aspectTable.push_back(addString(aspect));
+
+		return record;
+	};
+
+	// Record each live character and its relations
+	for (size_t i = 0; i < charList.entities().size(); i++) {
+		const character& chara = charList.entities()[i];
+		if (charList.removed(i))
+			continue;
+
+		entityRecord record = addEntity(chara, chara.historyIndex);
+
+		for (const entity::tagFeature& relation : chara.relations) {
+			relationTable.push_back({ addString(relation.name.str()), addString(relation.desc), uint32_t(tagTable.size()), uint32_t(relation.tags.size()) });
+
+			for (const rosterString& tag : relation.tags)
+				tagTable.push_back(addString(tag));
+		}
+
+		record.relationCount = chara.relations.size();
+		charTable.push_back(record);
+	}
+
+	// Record each live unit
+	for (size_t i = 0; i < unitList.entities().size(); i++)
+		if (!unitList.removed(i))
+			unitTable.push_back(addEntity(unitList.entities()[i], -1));
+
+	// Record the history, ranks and parameter tags
+	for (const rosterString& entry : charList.other)
+		historyTable.push_back(addString(entry));
+	for (const std::string& rank : charList.ranks)
+		charRankTable.push_back(addString(rank));
+	for (const std::string& rank : unitList.ranks)
+		groupRankTable.push_back(addString(rank));
+	for (const std::vector<std::string>& tag : charList.tags)
+		paramTable.push_back({ addString(tag[0]), addString(tag[1]) });
+
+	// Lay out the sections after the header
+	header fileHead = {};
+	std::copy(imageMagic, imageMagic + 4, fileHead.magic);
+	fileHead.version = imageVersion;
+
+	const void* sectionData[sectionCount] = {
+		sourceTable.data(), charTable.data(), unitTable.data(), aspectTable.data(), relationTable.data(), tagTable.data(),
+		historyTable.data(), paramTable.data(), charRankTable.data(), groupRankTable.data(), stringPool.data()
+	};
+	size_t sectionSize[sectionCount] = {
+		sourceTable.size(), charTable.size(), unitTable.size(), aspectTable.size(), relationTable.size(), tagTable.size(),
+		historyTable.size(), paramTable.size(), charRankTable.size(), groupRankTable.size(), stringPool.size()
+	};
+
+	uint64_t offset = sizeof(header);
+	for (int sec = 0; sec < sectionCount; sec++) {
+		// Align every section
+		offset = (offset + alignof(uint64_t) - 1) / alignof(uint64_t) * alignof(uint64_t);
+
+		fileHead.offset[sec] = offset;
+		fileHead.count[sec] = sectionSize[sec];
+		offset += sectionSize[sec] * sectionElement[sec];
+	}
+
+	// Write to a temporary file, so a failed write never leaves a partial image
+	std::string tempPath = path + ".tmp";
+	std::ofstream outFile(tempPath, std::ios::binary | std::ios::trunc);
+	if (!outFile)
+		return false;
+
+	outFile.write(reinterpret_cast<const char*>(&fileHead), sizeof(header));
+	for (int sec = 0; sec < sectionCount; sec++) {
+		// Pad up to the section's offset
+		while (uint64_t(outFile.tellp()) < fileHead.offset[sec])
+			outFile.put('\0');
+
+		outFile.write(static_cast<const char*>(sectionData[sec]), sectionSize[sec] * sectionElement[sec]);
+	}
+
+	outFile.close();
+	if (!outFile)
+		return false;
+
+	// Replace the previous image
+	std::error_code err;
+	std::filesystem::rename(tempPath, path, err);
+
+	return !err;
+}
+
+void rosterImage::load(characterList& charList, groupList& unitList) const {
+	if (head == nullptr)
+		return;
+
+	// Copy an entity's fields and aspects
+	auto loadEntity = [&](entity& ent, const entityRecord& record) {
+		ent.name = symbol(text(record.name));
+		ent.member = symbol(text(record.member));
+		ent.source = symbol(text(record.source));
+		ent.rank = record.rank;
+
+		ent.aspects.reserve(record.aspectCount);
+		for (size_t i = 0; i < record.aspectCount; i++)
+			ent.aspects.emplace_back(aspectAt(record, i));
+	};
+
+	// Copy the ranks and parameter tags
+	const stringRef* refs = table<stringRef>(characterRanks);
+	charList.ranks.assign(head->count[characterRanks], "");
+	for (size_t i = 0; i < head->count[characterRanks]; i++)
+		charList.ranks[i] = text(refs[i]);
+
+	refs = table<stringRef>(groupRanks);
+	unitList.ranks.assign(head->count[groupRanks], "");
+	for (size_t i = 0; i < head->count[groupRanks]; i++)
+		unitList.ranks[i] = text(refs[i]);
+
+	const paramTagRecord* paramTable = table<paramTagRecord>(paramTags);
+	for (size_t i = 0; i < head->count[paramTags]; i++)
+		charList.tags.push_back({ std::string(text(paramTable[i].name)), std::string(text(paramTable[i].desc)) });
+
+	// Copy the entities' text into the roster arena
+	std::pmr::memory_resource* arena = &RosterArena;
+
+	// Copy the characters and their relations
+	charList.entities().reserve(charList.entities().size() + characterCount());
+	for (size_t i = 0; i < characterCount(); i++) {
+		const entityRecord& record = characterAt(i);
+		character& chara = charList.entities().emplace_back(arena);
+		loadEntity(chara, record);
+
+		// Offset the history index past any history already loaded
+		if (record.historyIndex != -1)
+			chara.historyIndex = charList.other.size() + record.historyIndex;
+
+		chara.relations.reserve(record.relationCount);
+		for (size_t j = 0; j < record.relationCount; j++) {
+			const relationRecord& rel = relationAt(record, j);
+			entity::tagFeature& relation = chara.relations.emplace_back(arena);
+			relation.name = symbol(text(rel.name));
+			relation.desc = rosterString(text(rel.desc), arena);
+
+			relation.tags.reserve(rel.tagCount);
+			for (size_t k = 0; k < rel.tagCount; k++)
+				relation.tags.emplace_back(tagAt(rel, k));
+		}
+	}
+
+	// Copy the units
+	unitList.entities().reserve(unitList.entities().size() + unitCount());
+	for (size_t i = 0; i < unitCount(); i++)
+		loadEntity(unitList.entities().emplace_back(arena), unitAt(i));
+
+	// Copy the history
+	refs = table<stringRef>(history);
+	for (size_t i = 0; i < head->count[history]; i++)
+		charList.other.emplace_back(text(refs[i]), arena);
+}
+
+size_t rosterImage::characterCount() const {
+	return head == nullptr ? 0 : head->count[characters];
+}
+
+size_t rosterImage::unitCount() const {
+	return head == nullptr ? 0 : head->count[units];
+}
+
+const rosterImage::entityRecord& rosterImage::characterAt(int index) const {
+	return table<entityRecord>(characters)[index];
+}
+
+const rosterImage::entityRecord& rosterImage::unitAt(int index) const {
+	return table<entityRecord>(units)[index];
+}
+
+std::string_view rosterImage::aspectAt(const entityRecord& ent, int index) const {
+	return text(table<stringRef>(aspects)[ent.aspectBegin + index]);
+}
+
+const rosterImage::relationRecord& rosterImage::relationAt(const entityRecord& ent, int index) const {
+	return table<relationRecord>(relations)[ent.relationBegin + index];
+}
+
+std::string_view rosterImage::tagAt(const relationRecord& rel, int index) const {
+	return text(table<stringRef>(tags)[rel.tagBegin + index]);
+}
+
+std::string_view rosterImage::text(const stringRef& ref) const {
+	return std::string_view(table<char>(strings) + ref.offset, ref.size);
+}
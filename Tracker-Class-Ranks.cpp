@@ -0,0 +1,113 @@
+#include "Tracker.h"
+
+/*
+	Rank Bucket Scripts
+*/
+
+void rankIndex::build(const std::vector<character>& characterList, const std::vector<unit>& unitList) {
+	fill(characterBuckets, characterList);
+	fill(unitBuckets, unitList);
+	built = true;
+}
+
+bool rankIndex::current(size_t charSize, size_t unitSize) const {
+	return built && characterBuckets.ranks.size() == charSize && unitBuckets.ranks.size() == unitSize;
+}
+
+void rankIndex::updateCharacter(int position, int rank) {
+	if (built && position >= 0 && size_t(position) < characterBuckets.ranks.size())
+		move(characterBuckets, position, rank);
+}
+
+void rankIndex::updateUnit(int position, int rank) {
+	if (built && position >= 0 && size_t(position) < unitBuckets.ranks.size())
+		move(unitBuckets, position, rank);
+}
+
+void rankIndex::addCharacter(int position, int rank) {
+	if (built)
+		append(characterBuckets, position, rank);
+}
+
+void rankIndex::addUnit(int position, int rank) {
+	if (built)
+		append(unitBuckets, position, rank);
+}
+
+void rankIndex::removeCharacter(int position) {
+	if (built && position >= 0 && size_t(position) < characterBuckets.ranks.size())
+		drop(characterBuckets, position);
+}
+
+void rankIndex::removeUnit(int position) {
+	if (built && position >= 0 && size_t(position) < unitBuckets.ranks.size())
+		drop(unitBuckets, position);
+}
+
+const std::vector<int>& rankIndex::characters(int rank) const {
+	return bucket(characterBuckets, rank);
+}
+
+const std::vector<int>& rankIndex::units(int rank) const {
+	return bucket(unitBuckets, rank);
+}
+
+template <typename T>
+void rankIndex::fill(buckets& list, const std::vector<T>& entities) {
+	list.positions.clear();
+	list.ranks.resize(entities.size());
+
+	// File every position under its rank, in list order
+	for (size_t i = 0; i < entities.size(); i++) {
+		int rank = std::max(0, entities[i].rank);
+		if (size_t(rank) >= list.positions.size())
+			list.positions.resize(rank + 1);
+
+		list.positions[rank].push_back(i);
+		list.ranks[i] = rank;
+	}
+}
+
+void rankIndex::move(buckets& list, int position, int rank) {
+	rank = std::max(0, rank);
+	if (list.ranks[position] == rank)
+		return;
+
+	// Remove the position from its previous rank
+	drop(list, position);
+
+	// Insert it into its new rank
+	if (size_t(rank) >= list.positions.size())
+		list.positions.resize(rank + 1);
+
+	std::vector<int>& to = list.positions[rank];
+	to.insert(std::lower_bound(to.begin(), to.end(), position), position);
+	list.ranks[position] = rank;
+}
+
+void rankIndex::append(buckets& list, int position, int rank) {
+	if (size_t(position) != list.ranks.size())
+		return;
+
+	// Start the position under no rank, then file it
+	list.ranks.push_back(-1);
+	move(list, position, rank);
+}
+
+void rankIndex::drop(buckets& list, int position) {
+	int previous = list.ranks[position];
+	if (previous == -1)
+		return;
+
+	std::vector<int>& from = list.positions[previous];
+	auto found = std::lower_bound(from.begin(), from.end(), position);
+	if (found != from.end() && *found == position)
+		from.erase(found);
+
+	list.ranks[position] = -1;
+}
+
+const std::vector<int>& rankIndex::bucket(const buckets& list, int rank) {
+	static const std::vector<int> empty;
+	return rank >= 0 && size_t(rank) < list.positions.size() ? list.positions[rank] : empty;
+}
@@ -0,0 +1,86 @@
+#include "Tracker.h"
+
+/*
+	Save Cache Scripts
+*/
+
+bool saveCache::unchanged(const std::string& path, std::string_view content) {
+	auto found = fileHashes.find(path);
+
+	// Seed a file the first time it is compared, from the lines a save rewrites
+	if (found == fileHashes.end()) {
+		std::ifstream inFile(path);
+		if (!inFile)
+			return false;
+
+		// Keep the lines with a `: `, the rest being spare lines a save carries over
+		std::string saved, line;
+		while (getline(inFile, line)) {
+			if (line.find(": ") != std::string::npos) {
+				saved += line;
+				saved += "\n";
+			}
+		}
+
+		found = fileHashes.emplace(path, hash(saved)).first;
+	}
+
+	return found->second == hash(content);
+}
+
+void saveCache::note(const std::string& path, std::string_view content) {
+	fileHashes[path] = hash(content);
+}
+
+void saveCache::forget(const std::string& path) {
+	fileHashes.erase(path);
+}
+
+std::string saveCache::path(const character& chara) {
+	return "Characters/" + chara.name.str() + ".txt";
+}
+
+std::string saveCache::path(const unit& uni) {
+	return "Units/" + uni.name.str() + ".txt";
+}
+
+// Write a rank's name, leaving it blank past the known ranks
+void writeRank(support::outputSink& out, const std::vector<std::string>& ranks, int rank) {
+	out << "Rank: ";
+	if (rank >= 0 && size_t(rank) < ranks.size())
+		out << ranks[rank];
+	out << "\n";
+}
+
+void saveCache::serialize(support::outputSink& out, const character& chara) {
+	writeRank(out, CharacterList.ranks, chara.rank);
+	out << "Member: " << chara.member << "\n";
+	for (const rosterString& aspect : chara.aspects)
+		out << "Aspect: " << aspect << "\n";
+	// Write a relation's tags in the form the loader reads them back, `Name <tag,tag> desc`
+	for (const entity::tagFeature& relation : chara.relations) {
+		out << "Relation: ";
+		if (relation.tags.empty())
+			out << relation.name << ": " << relation.desc;
+		else
+			relation.output(out);
+		out << "\n";
+	}
+}
+
+void saveCache::serialize(support::outputSink& out, const unit& uni) {
+	writeRank(out, GroupList.ranks, uni.rank);
+	out << "Member: " << uni.member << "\n";
+	for (const rosterString& aspect : uni.aspects)
+		out << "Aspect: " << aspect << "\n";
+}
+
+uint64_t saveCache::hash(std::string_view content) {
+	uint64_t value = 14695981039346656037ull;
+	for (unsigned char byte : content) {
+		value ^= byte;
+		value *= 1099511628211ull;
+	}
+
+	return value;
+}
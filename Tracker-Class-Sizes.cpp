@@ -0,0 +1,97 @@
+#include "Tracker.h"
+#include <array>
+
+/*
+	Unit Size Scripts
+*/
+
+void unitSizes::build(const std::vector<character>& characterList, const unitAncestors& tree) {
+	size_t count = tree.preorder().size();
+	directCounts.assign(count, 0);
+
+	// Count each character in the unit it belongs to
+	for (const character& chara : characterList) {
+		int pos = tree.find(chara.member);
+		if (pos != -1)
+			directCounts[pos]++;
+	}
+
+	// Add each unit's total to its parent, every unit after the units below it
+	totalCounts = directCounts;
+	const std::vector<int>& order = tree.preorder();
+
+	for (auto node = order.rbegin(); node != order.rend(); node++)
+		if (tree.parent(*node) != -1)
+			totalCounts[tree.parent(*node)] += totalCounts[*node];
+
+	characterCount = characterList.size();
+	built = true;
+}
+
+bool unitSizes::current(size_t charSize, size_t unitSize) const {
+	return built && characterCount == charSize && directCounts.size() == unitSize;
+}
+
+void unitSizes::moveCharacter(const unitAncestors& tree, const symbol& from, const symbol& to) {
+	if (!built || from == to)
+		return;
+
+	int previous = tree.find(from);
+	if (previous != -1) {
+		directCounts[previous]--;
+		addTotal(tree, previous, -1);
+	}
+
+	int next = tree.find(to);
+	if (next != -1) {
+		directCounts[next]++;
+		addTotal(tree, next, 1);
+	}
+}
+
+void unitSizes::addCharacter(const unitAncestors& tree, int position, const symbol& member) {
+	if (!built || size_t(position) != characterCount)
+		return;
+
+	characterCount++;
+	moveCharacter(tree, symbol::none, member);
+}
+
+void unitSizes::removeCharacter(const unitAncestors& tree, const symbol& member) {
+	moveCharacter(tree, member, symbol::none);
+}
+
+// Least and most members of each rank, up to the largest rank an int holds
+static const std::array<std::pair<int, int>, 31>& rankBounds() {
+	static const std::array<std::pair<int, int>, 31> bounds = [] {
+		std::array<std::pair<int, int>, 31> table;
+		for (size_t r = 0; r < table.size(); r++)
+			table[r] = { 1 << r, r == 0 ? 1 : 3 << (r - 1) };
+		return table;
+	}();
+
+	return bounds;
+}
+
+bool unitSizes::fits(int rank, int size) {
+	const auto& bounds = rankBounds();
+
+	if (rank < 0 || size_t(rank) >= bounds.size())
+		return false;
+
+	return bounds[rank].first <= size && size <= bounds[rank].second;
+}
+
+int unitSizes::capacity(int rank) {
+	const auto& bounds = rankBounds();
+
+	if (rank < 0 || size_t(rank) >= bounds.size())
+		return 0;
+
+	return bounds[rank].second;
+}
+
+void unitSizes::addTotal(const unitAncestors& tree, int position, int count) {
+	for (int pos = position; pos != -1; pos = tree.parent(pos))
+		totalCounts[pos] += count;
+}
@@ -0,0 +1,137 @@
+#include "Tracker.h"
+
+/*
+	Entity Store Scripts
+*/
+
+template <typename T>
+typename entityStore<T>::handle entityStore<T>::add(T ent) {
+	int position = items.size();
+
+	// Hand out slots for anything added straight to the list first
+	while (slotOf.size() < items.size())
+		slotOf.push_back(newSlot(slotOf.size()));
+
+	index.add(ent.name, position);
+	items.push_back(std::move(ent));
+	slotOf.push_back(newSlot(position));
+
+	return at(position);
+}
+
+template <typename T>
+void entityStore<T>::remove(handle ent) {
+	int pos = position(ent);
+	if (pos == -1)
+		return;
+
+	// Move a repeated name on to its next live entity
+	const symbol& name = items[pos].name;
+	int next = -1;
+
+	if (index.find(name) == pos && index.occurrences(name) > 1) {
+		for (size_t i = pos + 1; i < items.size() && next == -1; i++)
+			if (!removed(i) && items[i].name == name)
+				next = i;
+	}
+
+	index.remove(name, pos, next);
+
+	// Stop the slot's handles resolving and free it for reuse
+	slots[ent.slot].generation++;
+	freeSlots.push_back(ent.slot);
+	slotOf[pos] = noSlot;
+	dropped++;
+}
+
+template <typename T>
+bool entityStore<T>::removed(int position) const {
+	return position >= 0 && size_t(position) < slotOf.size() && slotOf[position] == noSlot;
+}
+
+template <typename T>
+typename entityStore<T>::handle entityStore<T>::find(const symbol& name) const {
+	int pos = index.find(name);
+	return pos == -1 ? handle() : at(pos);
+}
+
+template <typename T>
+typename entityStore<T>::handle entityStore<T>::at(int position) const {
+	if (position < 0 || size_t(position) >= slotOf.size() || slotOf[position] == noSlot)
+		return handle();
+
+	return { slotOf[position], slots[slotOf[position]].generation };
+}
+
+template <typename T>
+int entityStore<T>::position(handle ent) const {
+	if (ent.slot >= slots.size() || slots[ent.slot].generation != ent.generation)
+		return -1;
+
+	return slots[ent.slot].position;
+}
+
+template <typename T>
+T* entityStore<T>::get(handle ent) {
+	int pos = position(ent);
+	return pos == -1 ? nullptr : &items[pos];
+}
+
+template <typename T>
+void entityStore<T>::reindex() {
+	// A list shortened outside the store can't be matched to its handles, so drop them all
+	if (slotOf.size() > items.size()) {
+		for (slotRecord& slot : slots)
+			slot.generation++;
+
+		freeSlots.clear();
+		for (uint32_t i = slots.size(); i > 0; i--)
+			freeSlots.push_back(i - 1);
+		slotOf.clear();
+	}
+
+	// Hand out slots for anything added straight to the list
+	while (slotOf.size() < items.size())
+		slotOf.push_back(newSlot(slotOf.size()));
+
+	// Drop the tombstones, moving each live entity down in order
+	size_t kept = 0;
+	for (size_t pos = 0; pos < items.size(); pos++) {
+		if (slotOf[pos] == noSlot)
+			continue;
+
+		if (kept != pos) {
+			items[kept] = std::move(items[pos]);
+			slotOf[kept] = slotOf[pos];
+		}
+
+		slots[slotOf[kept]].position = kept;
+		kept++;
+	}
+
+	items.erase(items.begin() + kept, items.end());
+	slotOf.resize(kept);
+	dropped = 0;
+
+	// Rebuild the name index
+	index.clear();
+	for (size_t i = 0; i < items.size(); i++)
+		index.add(items[i].name, i);
+}
+
+template <typename T>
+uint32_t entityStore<T>::newSlot(int position) {
+	if (freeSlots.empty()) {
+		slots.push_back({ position, 0 });
+		return slots.size() - 1;
+	}
+
+	uint32_t slot = freeSlots.back();
+	freeSlots.pop_back();
+	slots[slot].position = position;
+	return slot;
+}
+
+// The stores of the shared lists
+template class entityStore<character>;
+template class entityStore<unit>;
@@ -0,0 +1,83 @@
+#include "Tracker.h"
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <stdexcept>
+#include <unordered_map>
+
+/*
+	Symbol Scripts
+*/
+
+const symbol symbol::none;
+
+// Roster-wide table of interned names
+struct symbolTable {
+	// Texts live in fixed blocks, so they never move and can be read without the lock
+	static const uint32_t blockBits = 12;
+	static const uint32_t blockSize = 1 << blockBits;
+	static const uint32_t maxBlocks = 1 << 16;
+
+	std::shared_mutex lock;
+	std::unordered_map<std::string_view, uint32_t> ids;
+	std::vector<std::unique_ptr<std::string[]>> blocks = std::vector<std::unique_ptr<std::string[]>>(maxBlocks);
+	uint32_t count = 0;
+
+	symbolTable() {
+		// Reserve id 0 for the "None" sentinel
+		add("None");
+	}
+
+	// Store a new text, the lock must be held
+	uint32_t add(std::string_view text) {
+		// Refuse a text once every block is full, rather than wrap the ids
+		if ((count >> blockBits) >= maxBlocks)
+			throw std::length_error("symbol table is full");
+
+		// Start a new block when the last is full
+		if (count % blockSize == 0)
+			blocks[count >> blockBits] = std::make_unique<std::string[]>(blockSize);
+
+		std::string& stored = blocks[count >> blockBits][count & (blockSize - 1)];
+		stored = text;
+		ids.emplace(stored, count);
+
+		return count++;
+	}
+};
+
+static symbolTable& table() {
+	static symbolTable symbols;
+	return symbols;
+}
+
+symbol::symbol(std::string_view text) {
+	symbolTable& symbols = table();
+
+	// Look for an existing symbol, shared with other readers
+	{
+		std::shared_lock<std::shared_mutex> read(symbols.lock);
+		auto found = symbols.ids.find(text);
+		if (found != symbols.ids.end()) {
+			index = found->second;
+			return;
+		}
+	}
+
+	// Add the symbol, checking again in case another thread added it first
+	std::unique_lock<std::shared_mutex> write(symbols.lock);
+	auto found = symbols.ids.find(text);
+	index = found != symbols.ids.end() ? found->second : symbols.add(text);
+}
+
+const std::string& symbol::str() const {
+	return table().blocks[index >> symbolTable::blockBits][index & (symbolTable::blockSize - 1)];
+}
+
+std::ostream& operator<<(std::ostream& out, const symbol& sym) {
+	return out << sym.str();
+}
+
+support::outputSink& operator<<(support::outputSink& out, const symbol& sym) {
+	return out << std::string_view(sym.str());
+}
@@ -0,0 +1,106 @@
+#include "Tracker.h"
+
+/*
+	Relation Tag Index Scripts
+*/
+
+void tagIndex::build(const std::vector<character>& characterList) {
+	postings.clear();
+	sourceTags.assign(characterList.size(), {});
+
+	// File every relation under each of its tags, in list order
+	for (size_t i = 0; i < characterList.size(); i++)
+		add(characterList[i], i);
+
+	characterCount = characterList.size();
+	built = true;
+}
+
+void tagIndex::update(const std::vector<character>& characterList, int position) {
+	if (!current(characterList.size()) || position < 0 || size_t(position) >= characterCount)
+		return;
+
+	// Drop the character's previous postings, then file its current relations
+	drop(position);
+	add(characterList[position], position);
+}
+
+void tagIndex::insert(const std::vector<character>& characterList, int position) {
+	if (!built || size_t(position) != characterCount || size_t(position) >= characterList.size())
+		return;
+
+	sourceTags.emplace_back();
+	characterCount++;
+	add(characterList[position], position);
+}
+
+void tagIndex::remove(int position) {
+	if (built && position >= 0 && size_t(position) < characterCount)
+		drop(position);
+}
+
+const std::vector<tagIndex::posting>& tagIndex::tagged(const symbol& tag) const {
+	static const std::vector<posting> empty;
+
+	auto found = postings.find(tag);
+	return found == postings.end() ? empty : found->second;
+}
+
+std::vector<symbol> tagIndex::tags() const {
+	std::vector<symbol> names;
+	for (const auto& [tag, list] : postings)
+		names.push_back(tag);
+
+	std::sort(names.begin(), names.end(), [](const symbol& a, const symbol& b) { return a.str() < b.str(); });
+	return names;
+}
+
+void tagIndex::drop(int position) {
+	auto bySource = [](const posting& post, int source) { return post.source < source; };
+
+	// Drop the character's postings from each tag it carried
+	for (const symbol& tag : sourceTags[position]) {
+		auto found = postings.find(tag);
+		if (found == postings.end())
+			continue;
+
+		std::vector<posting>& list = found->second;
+		auto first = std::lower_bound(list.begin(), list.end(), position, bySource);
+		auto last = first;
+		while (last != list.end() && last->source == position)
+			last++;
+
+		list.erase(first, last);
+		if (list.empty())
+			postings.erase(found);
+	}
+
+	sourceTags[position].clear();
+}
+
+void tagIndex::add(const character& chara, int position) {
+	auto bySource = [](int source, const posting& post) { return source < post.source; };
+	std::vector<symbol>& filed = sourceTags[position];
+
+	for (size_t i = 0; i < chara.relations.size(); i++) {
+		const entity::tagFeature& relation = chara.relations[i];
+
+		for (size_t j = 0; j < relation.tags.size(); j++) {
+			symbol tag(std::string_view(relation.tags[j]));
+
+			// Post a tag repeated within the relation once
+			bool repeated = false;
+			for (size_t k = 0; k < j && !repeated; k++)
+				repeated = relation.tags[k] == relation.tags[j];
+			if (repeated)
+				continue;
+
+			// Insert after the character's earlier postings, which is the end while building
+			std::vector<posting>& list = postings[tag];
+			list.insert(std::upper_bound(list.begin(), list.end(), position, bySource), { position, int(i), relation.name });
+
+			if (std::find(filed.begin(), filed.end(), tag) == filed.end())
+				filed.push_back(tag);
+		}
+	}
+}
@@ -4,21 +4,18 @@
 	Unit Scripts
 */
 
-std::string unit::output() const {
-	std::string returnStr;
-
-	returnStr += "Name: " + name + "\n";
-	returnStr += "Rank: " + GroupList.ranks[rank] + "\n";
-	returnStr += "Member: " + member + "\n";
-	for (std::string aspect : aspects)
-		returnStr += "Aspect: " + aspect + "\n";
-
-	return returnStr;
+void unit::output(support::outputSink& out) const {
+	out << "Name: " << name << "\n";
+	out << "Rank: " << GroupList.ranks[rank] << "\n";
+	out << "Member: " << member << "\n";
+	for (const rosterString& aspect : aspects)
+		out << "Aspect: " << aspect << "\n";
 }
 
-void unit::addFeature(const std::string& featString) {
-	// Attempt to split the input string by delims
-	std::vector<std::string> feat = input::splitDelim(featString);
+void unit::addFeature(std::string_view featString) {
+	// Attempt to split the input string by delims into a reused buffer of views
+	thread_local std::vector<std::string_view> feat;
+	input::splitDelim(featString, feat);
 
 	// Rank: Set the rank to [1]'s integer equivalent
 	if (feat[0] == "Rank") {
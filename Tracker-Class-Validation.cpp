@@ -0,0 +1,177 @@
+#include "Tracker.h"
+
+/*
+	Validation Cache Scripts
+*/
+
+// Visit every live entity holding a name, through the index unless the name repeats
+template <typename T, typename F>
+void forEachNamed(const entityStore<T>& store, const symbol& name, F visit) {
+	const std::vector<T>& list = store.entities();
+	int count = store.index.occurrences(name);
+
+	if (count == 1)
+		visit(list[store.index.find(name)], false);
+	else if (count > 1) {
+		// Flag every entity after the first as repeated, skipping tombstones
+		bool repeated = false;
+		for (size_t i = 0; i < list.size(); i++) {
+			if (list[i].name == name && !store.removed(i)) {
+				visit(list[i], repeated);
+				repeated = true;
+			}
+		}
+	}
+}
+
+void validationCache::markDirty(const symbol& name) {
+	dirty.insert(name);
+	edits++;
+}
+
+const std::vector<diagnostic>& validationCache::check(const characterList& charList, const groupList& unitList, unsigned int threadCount) {
+	// Nothing changed since the last check
+	if (built && checked == edits)
+		return results;
+
+	// Trust the cache only while the indexes match the lists and few names changed
+	size_t rows = charList.entities().size() + unitList.entities().size();
+	bool indexed = charList.index.count() + charList.tombstones() == charList.entities().size()
+		&& unitList.index.count() + unitList.tombstones() == unitList.entities().size();
+
+	if (!built || !indexed || dirty.size() * 8 > rows)
+		rebuild(charList, unitList, threadCount);
+	else {
+		// Recheck the edited names and every name referencing them
+		std::unordered_set<symbol> affected = dirty;
+
+		for (const symbol& name : dirty) {
+			auto by = referencedBy.find(name);
+			if (by != referencedBy.end())
+				affected.insert(by->second.begin(), by->second.end());
+		}
+
+		for (const symbol& name : affected)
+			recheck(name, charList, unitList);
+	}
+
+	dirty.clear();
+	checked = edits;
+
+	// Gather the cached problems
+	results.clear();
+	for (const auto& [name, found] : problems)
+		results.insert(results.end(), found.begin(), found.end());
+
+	// Order them by the position of the entity holding each, characters before units
+	size_t charCount = charList.entities().size();
+	auto row = [&](const diagnostic& diag) -> size_t {
+		return diag.unitEntity ? charCount + unitList.index.find(diag.entity) : charList.index.find(diag.entity);
+	};
+
+	std::stable_sort(results.begin(), results.end(), [&](const diagnostic& a, const diagnostic& b) { return row(a) < row(b); });
+
+	return results;
+}
+
+void validationCache::rebuild(const characterList& charList, const groupList& unitList, unsigned int threadCount) {
+	problems.clear();
+	references.clear();
+	referencedBy.clear();
+
+	// Group the problems by the name of the entity holding them, leaving out tombstones
+	for (const diagnostic& diag : interactions::validate(charList, unitList, threadCount))
+		problems[diag.entity].push_back(diag);
+
+	// Note what every live entity references
+	for (size_t i = 0; i < charList.entities().size(); i++) {
+		const character& chara = charList.entities()[i];
+		if (charList.removed(i))
+			continue;
+
+		if (chara.member != symbol::none)
+			addReference(chara.name, chara.member);
+
+		for (const entity::tagFeature& relation : chara.relations)
+			addReference(chara.name, relation.name);
+	}
+
+	for (size_t i = 0; i < unitList.entities().size(); i++) {
+		const unit& uni = unitList.entities()[i];
+		if (!unitList.removed(i) && uni.member != symbol::none)
+			addReference(uni.name, uni.member);
+	}
+
+	built = true;
+}
+
+void validationCache::recheck(const symbol& name, const characterList& charList, const groupList& unitList) {
+	// Forget what the name's entities referenced before the edit
+	auto old = references.find(name);
+
+	if (old != references.end()) {
+		for (const symbol& target : old->second) {
+			auto by = referencedBy.find(target);
+			if (by == referencedBy.end())
+				continue;
+
+			by->second.erase(name);
+			if (by->second.empty())
+				referencedBy.erase(by);
+		}
+
+		references.erase(old);
+	}
+
+	std::vector<diagnostic> found;
+
+	// Check every character holding the name
+	forEachNamed<character>(charList, name, [&](const character& chara, bool repeated) {
+		if (repeated)
+			found.push_back({ diagnostic::duplicateName, name, false, "Name", name });
+
+		// Report a missing unit membership
+		if (chara.member != symbol::none) {
+			addReference(name, chara.member);
+
+			if (unitList.index.find(chara.member) == -1)
+				found.push_back({ diagnostic::missingUnit, name, false, "Member", chara.member });
+		}
+
+		// Report each missing relation
+		for (const entity::tagFeature& relation : chara.relations) {
+			addReference(name, relation.name);
+
+			if (charList.index.find(relation.name) == -1)
+				found.push_back({ diagnostic::missingCharacter, name, false, "Relation", relation.name });
+		}
+	});
+
+	// Check every unit holding the name
+	forEachNamed<unit>(unitList, name, [&](const unit& uni, bool repeated) {
+		if (repeated)
+			found.push_back({ diagnostic::duplicateName, name, true, "Name", name });
+
+		if (uni.member == symbol::none)
+			return;
+
+		addReference(name, uni.member);
+
+		// Report a unit belonging to itself or to a missing unit
+		if (uni.member == uni.name)
+			found.push_back({ diagnostic::selfMembership, name, true, "Member", uni.member });
+		else if (unitList.index.find(uni.member) == -1)
+			found.push_back({ diagnostic::missingUnit, name, true, "Member", uni.member });
+	});
+
+	// Keep only names with problems
+	if (found.empty())
+		problems.erase(name);
+	else
+		problems[name] = std::move(found);
+}
+
+void validationCache::addReference(const symbol& name, const symbol& target) {
+	references[name].push_back(target);
+	referencedBy[target].insert(name);
+}
@@ -0,0 +1,214 @@
+#include "Tracker.h"
+#include <filesystem>
+
+#ifndef _WIN32
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+/*
+	Save Writer Scripts
+*/
+
+saveWriter::saveWriter(unsigned int threadCount) {
+	for (unsigned int i = 0; i < std::max(1u, threadCount); i++)
+		threads.emplace_back(&saveWriter::work, this);
+}
+
+saveWriter::~saveWriter() {
+	wait();
+
+	{
+		std::lock_guard<std::mutex> guard(lock);
+		stopping = true;
+	}
+	wake.notify_all();
+
+	for (std::thread& thread : threads)
+		thread.join();
+}
+
+void saveWriter::submit(std::string path, std::string content) {
+	{
+		// A file still queued keeps its place, writing only the latest content
+		std::lock_guard<std::mutex> guard(lock);
+		pending[std::move(path)] = std::move(content);
+	}
+	wake.notify_one();
+}
+
+void saveWriter::wait() {
+	std::unique_lock<std::mutex> guard(lock);
+	idle.wait(guard, [this] { return pending.empty() && writing.empty(); });
+}
+
+void saveWriter::report(saveCache& saved) {
+	int done;
+	std::vector<std::string> lost;
+
+	{
+		std::lock_guard<std::mutex> guard(lock);
+		done = written;
+		lost.swap(failed);
+		written = 0;
+	}
+
+	// Forget the failed files, so the next save retries them
+	for (const std::string& path : lost) {
+		saved.forget(path);
+		std::cout << "Unable to write " << path << "\n";
+	}
+
+	if (done > 0)
+		std::cout << "Saved " << done << (done == 1 ? " changed entity.\n" : " changed entities.\n");
+
+	if (done > 0 || !lost.empty())
+		std::cout << "\n";
+}
+
+void saveWriter::work() {
+	std::unique_lock<std::mutex> guard(lock);
+
+	while (true) {
+		// Claim a batch of queued files, skipping any another thread is still writing
+		std::vector<writeJob> batch;
+
+		for (auto it = pending.begin(); it != pending.end() && batch.size() < batchSize;) {
+			if (writing.count(it->first)) {
+				it++;
+				continue;
+			}
+
+			writing.insert(it->first);
+			batch.push_back({ it->first, std::move(it->second) });
+			it = pending.erase(it);
+		}
+
+		if (batch.empty()) {
+			if (stopping)
+				return;
+
+			wake.wait(guard);
+			continue;
+		}
+
+		// Write the batch without holding the queue
+		guard.unlock();
+		std::vector<std::string> lost = writeBatch(batch);
+		guard.lock();
+
+		for (const writeJob& job : batch)
+			writing.erase(job.path);
+
+		written += batch.size() - lost.size();
+		failed.insert(failed.end(), lost.begin(), lost.end());
+
+		// A finished file may free a newer save of the same file
+		wake.notify_all();
+		idle.notify_all();
+	}
+}
+
+std::vector<std::string> saveWriter::writeBatch(std::vector<writeJob>& batch) {
+	std::vector<std::string> lost;
+	std::vector<bool> ok(batch.size(), true);
+
+#ifndef _WIN32
+	std::vector<int> files(batch.size(), -1);
+#endif
+
+	for (size_t i = 0; i < batch.size(); i++) {
+		writeJob& job = batch[i];
+
+		// Save the spare lines, those without a `: `
+		std::ifstream inFile(job.path);
+		std::string line;
+
+		while (getline(inFile, line)) {
+			if (line.find(": ") == std::string::npos)
+				job.content += line + "\n";
+		}
+		inFile.close();
+
+		// Write a temporary file, to be swapped in so the file is never left half written
+		std::string temp = job.path + ".tmp";
+
+#ifdef _WIN32
+		std::ofstream outFile(temp);
+		outFile << job.content;
+		outFile.close();
+		ok[i] = bool(outFile);
+#else
+		do
+			files[i] = open(temp.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+		while (files[i] < 0 && errno == EINTR);
+		ok[i] = files[i] >= 0;
+
+		// Write until every byte is out, retrying an interrupted write and continuing a short one
+		for (size_t done = 0; ok[i] && done < job.content.size();) {
+			ssize_t count = write(files[i], job.content.data() + done, job.content.size() - done);
+
+			if (count < 0 && errno == EINTR)
+				continue;
+
+			ok[i] = count > 0;
+			done += ok[i] ? count : 0;
+		}
+#endif
+	}
+
+#ifndef _WIN32
+	// Flush the batch's files together, before any replaces its original
+	std::set<std::string> folders;
+
+	for (size_t i = 0; i < batch.size(); i++) {
+		if (files[i] < 0)
+			continue;
+
+		// Retry a flush cut short by a signal
+		if (ok[i]) {
+			int synced;
+			do
+				synced = fsync(files[i]);
+			while (synced != 0 && errno == EINTR);
+
+			ok[i] = synced == 0;
+		}
+		close(files[i]);
+	}
+#endif
+
+	// Swap in each written file
+	for (size_t i = 0; i < batch.size(); i++) {
+		std::string temp = batch[i].path + ".tmp";
+		std::error_code err;
+
+		if (ok[i])
+			std::filesystem::rename(temp, batch[i].path, err);
+
+		if (!ok[i] || err) {
+			std::filesystem::remove(temp, err);
+			lost.push_back(batch[i].path);
+			continue;
+		}
+
+#ifndef _WIN32
+		folders.insert(std::filesystem::path(batch[i].path).parent_path().string());
+#endif
+	}
+
+#ifndef _WIN32
+	// Flush each folder once, so the swaps survive a crash
+	for (const std::string& folder : folders) {
+		int dir = open(folder.empty() ? "." : folder.c_str(), O_RDONLY);
+		if (dir < 0)
+			continue;
+
+		fsync(dir);
+		close(dir);
+	}
+#endif
+
+	return lost;
+}
@@ -1,113 +1,103 @@
 #include "Tracker.h"
+#include <condition_variable>
+#include <mutex>
 
 /*
 * Output Namespace Functions
 *
 */
 
-void recPrint(const std::vector<unit>& unitList, const std::vector<character>& characterList, const std::vector<std::vector<std::string>>& unitDets, int thisUnitInd, int depth) {
+// Print a unit, the units below it and its characters, walking the ancestor index so a membership cycle is never followed
+void recPrint(support::outputSink& out, const std::vector<unit>& unitList, const std::vector<character>& characterList, const unitHierarchy& tree,
+	const unitAncestors& ancestors, const unitSizes& sizes, int thisUnitInd, int depth) {
+	const unit& thisUnit = unitList[thisUnitInd];
+
 	// Print blanks for indentation
 	for (int i = 0; i < depth; i++)
-		std::cout << "    ";
+		out << "    ";
 
 	// Print the name and rank
-	std::cout << "[" << GroupList.ranks[unitList[thisUnitInd].rank] << "] ";
-	std::cout << unitList[thisUnitInd].name;
-
-	// Print the size and max size
-	for (std::vector<std::string> currUnit : unitDets) {
-		if (currUnit[0] == unitList[thisUnitInd].name) {
-			std::cout << " (" << currUnit[1] << "/";
-			std::cout << (3 * pow(2, unitList[thisUnitInd].rank - 1)) << ")\n";
-		}
-	}
+	out << "[" << GroupList.ranks[thisUnit.rank] << "] ";
+	out << thisUnit.name;
+
+	// Print the size and the max size the size check allows
+	out << " (" << sizes.total(thisUnitInd) << "/";
+	out << unitSizes::capacity(thisUnit.rank) << ")\n";
 
 	// Print any units that belongs to this unit
-	for (int i = 0; i < unitList.size(); i++) {
-		if (unitList[i].member != unitList[thisUnitInd].name)
-			continue;
-		recPrint(unitList, characterList, unitDets, i, depth + 1);
-	}
+	for (int i : ancestors.children(thisUnitInd))
+		recPrint(out, unitList, characterList, tree, ancestors, sizes, i, depth + 1);
 
-	// Print any character that belongs to this unit
-	for (character currChar : characterList) {
-		if (currChar.member != unitList[thisUnitInd].name)
-			continue;
+	// Print any character that belongs to this unit, under the unit's first position as the sizes count them
+	if (ancestors.find(thisUnit.name) != thisUnitInd)
+		return;
+
+	for (int i : tree.characters(thisUnit.name)) {
+		const character& currChar = characterList[i];
 
-		for (int i = 0; i < depth + 1; i++)
-			std::cout << "    ";
+		for (int j = 0; j < depth + 1; j++)
+			out << "    ";
 
-		std::cout << "[" << CharacterList.ranks[currChar.rank] << "] ";
-		std::cout << currChar.name << "\n";
+		out << "[" << CharacterList.ranks[currChar.rank] << "] ";
+		out << currChar.name << "\n";
 	}
 
 	return;
 }
 
 void output::printAll(const std::vector<character>& characterList, const std::vector<unit>& unitList) {
+	support::outputSink out(std::cout);
+
 	// Print all characters
-	std::cout << "Characters" << "\n";
-	for (character entry : characterList) {
-		std::cout << entry.output();
-		std::cout << "\n";
+	out << "Characters" << "\n";
+	for (const character& entry : characterList) {
+		entry.output(out);
+		out << "\n";
 	}
 
 	// Print all units
-	std::cout << "Units" << "\n";
-	for (unit entry : unitList) {
-		std::cout << entry.output();
-		std::cout << "\n";
+	out << "Units" << "\n";
+	for (const unit& entry : unitList) {
+		entry.output(out);
+		out << "\n";
 	}
 }
 
-void output::printRank(std::vector<character> characterList, std::vector<unit> unitList) {
+void output::printRank(const std::vector<character>& characterList, const std::vector<unit>& unitList) {
+	support::outputSink out(std::cout);
+
 	// Declare a variable to track the previously printed rank
 	int prevRank = -1;
 
-	// Sort characters in order of rank integer
-	std::sort(characterList.begin(), characterList.end(),
-		[](character a, character b) {
-			return a.rank < b.rank;
-		});
-
-	// Sort units in order of rank integer
-	std::sort(unitList.begin(), unitList.end(),
-		[](unit a, unit b) {
-			return a.rank < b.rank;
-		});
-
-	// For each unit
-	for (unit uni : unitList) {
-		// If the rank has changed, print a new header
-		if (prevRank != uni.rank) {
-			std::cout << "\n" << GroupList.ranks[uni.rank] << "\n";
-			prevRank = uni.rank;
-		}
-
-		// Print the unit and it's membership
-		std::cout << uni.name;
-		if (uni.member != "None")
-			std::cout << " [" << uni.member << "]";
-		std::cout << "\n";
-	}
+	// Walk the rank buckets in order of rank integer
+	rankIndex scratch;
+	const rankIndex& ranks = simpleFind::ranks(characterList, unitList, scratch);
+
+	// Print each entity of a list, bucket by bucket
+	auto printRanks = [&](const auto& list, const std::vector<std::string>& rankNames, int rankCount, auto bucket) {
+		for (int rank = 0; rank < rankCount; rank++) {
+			for (int pos : bucket(rank)) {
+				// If the rank has changed, print a new header
+				if (prevRank != rank) {
+					out << "\n" << rankNames[rank] << "\n";
+					prevRank = rank;
+				}
 
-	// For each character
-	for (character chara : characterList) {
-		// If the rank has changed, print a new header
-		if (prevRank != chara.rank) {
-			std::cout << "\n" << CharacterList.ranks[chara.rank] << "\n";
-			prevRank = chara.rank;
+				// Print the entity and it's membership
+				out << list[pos].name;
+				if (list[pos].member != symbol::none)
+					out << " [" << list[pos].member << "]";
+				out << "\n";
+			}
 		}
+	};
 
-		// Print the unit and it's membership
-		std::cout << chara.name;
-		if (chara.member != "None")
-			std::cout << " [" << chara.member << "]";
-		std::cout << "\n";
-	}
+	// Print each unit, then each character
+	printRanks(unitList, GroupList.ranks, ranks.unitRanks(), [&](int rank) -> const std::vector<int>& { return ranks.units(rank); });
+	printRanks(characterList, CharacterList.ranks, ranks.characterRanks(), [&](int rank) -> const std::vector<int>& { return ranks.characters(rank); });
 
 	// Final newline for formatting
-	std::cout << "\n";
+	out << "\n";
 }
 
 void output::printFull(const std::vector<character>& characterList, const std::vector<unit>& unitList) {
@@ -124,97 +114,223 @@ void output::printFull(const std::vector<character>& characterList, const std::v
 
 
 void output::printFullUnit(const std::vector<character>& characterList, const std::vector<unit>& unitList) {
-	// Variables
-	std::vector<std::vector<std::string>> unitDets;
-	std::vector<std::vector<std::string>> unitInfo;
-	std::vector<std::string> unitNames;
-	std::vector<int> unitSizes;
-
-	// Store the unit's name and necessary information and initialize the units' size
-	for (unit unit : unitList) {
-		unitInfo.push_back({ unit.name, std::to_string(unit.rank), unit.member });
-		unitSizes.push_back(0);
-	}
+	// Find the members of each unit once
+	unitHierarchy scratchTree;
+	const unitHierarchy& tree = simpleFind::hierarchy(characterList, scratchTree);
+
+	// Link each unit to its parent, with any cycle cut
+	unitAncestors scratchAncestors;
+	const unitAncestors& ancestors = simpleFind::ancestors(unitList, scratchAncestors);
+
+	// Count each unit's members bottom-up
+	unitSizes scratchSizes;
+	const unitSizes& sizes = simpleFind::sizes(characterList, unitList, scratchSizes);
 
-	// Sort unit info in order of rank integer
-	std::sort(unitInfo.begin(), unitInfo.end(),
-		[](std::vector<std::string> a, std::vector<std::string> b) {
-			return stoi(a[1]) < stoi(b[1]);
-		});
+	// Recusive print each unit without a parent and it's members
+	// Besides units belonging to no unit, this starts each cut cycle and each unit belonging to a missing unit
+	support::outputSink out(std::cout);
 
-	// Store the unit's name via sorted order and create a character holder
-	for (std::vector<std::string> unit : unitInfo) {
-		unitNames.push_back(unit[0]);
-		unitDets.push_back({ unit[0], "0" });
+	for (size_t i = 0; i < unitList.size(); i++)
+		if (ancestors.parent(i) == -1)
+			recPrint(out, unitList, characterList, tree, ancestors, sizes, i, 0);
+
+	// Print a newline for spacing
+	out << "\n";
+}
+
+// Write an entity's markdown entry
+void writeMarkdown(support::outputSink& out, const character& chara, const std::vector<rosterString>& history) {
+	out << "# " << chara.name << "\n";
+	chara.output(out);
+
+	if (chara.historyIndex != -1)
+		out << history[chara.historyIndex];
+}
+
+void writeMarkdown(support::outputSink& out, const unit& uni, const std::vector<rosterString>&) {
+	out << "# " << uni.name << "\n";
+	uni.output(out);
+}
+
+// Format contiguous chunks of a list across threads, writing each chunk in list order once it is ready
+template <typename T>
+void logListMD(const std::string& path, const std::vector<T>& list, const std::vector<rosterString>& history, unsigned int threadCount) {
+	std::ofstream outFile(path);
+
+	// Chunks large enough to keep each write big, with several per thread to even out the work
+	const size_t chunkSize = std::max<size_t>(256, list.size() / (std::max(1u, threadCount) * 8) + 1);
+	size_t chunkCount = (list.size() + chunkSize - 1) / chunkSize;
+	threadCount = std::min<size_t>(threadCount, chunkCount);
+
+	// If only one thread is usable, format straight into the file
+	if (threadCount <= 1) {
+		support::outputSink out(outFile);
+		for (const T& ent : list)
+			writeMarkdown(out, ent, history);
+		return;
 	}
 
-	// For each character
-	for (character character : characterList) {
-		// Try to find it's unit membership
-		auto charMem = find(unitNames.begin(), unitNames.end(), character.member);
+	// Each worker claims the next unformatted chunk until none remain
+	std::vector<std::string> chunks(chunkCount);
+	std::vector<char> ready(chunkCount, false);
+	std::atomic<size_t> nextChunk = 0;
+	std::mutex readyLock;
+	std::condition_variable chunkReady;
+
+	auto worker = [&]() {
+		for (size_t i = nextChunk++; i < chunkCount; i = nextChunk++) {
+			support::outputSink out;
+			for (size_t j = i * chunkSize; j < std::min(list.size(), (i + 1) * chunkSize); j++)
+				writeMarkdown(out, list[j], history);
+
+			// Hand the chunk to the writer
+			{
+				std::lock_guard<std::mutex> guard(readyLock);
+				chunks[i] = out.take();
+				ready[i] = true;
+			}
+			chunkReady.notify_one();
+		}
+	};
 
-		// If it belongs to a unit, add to the unit's size
-		if (charMem != unitNames.end()) {
-			unitSizes[std::distance(unitNames.begin(), charMem)] += 1;
+	std::vector<std::thread> workers;
+	for (unsigned int i = 0; i < threadCount; i++)
+		workers.emplace_back(worker);
+
+	// Write the chunks in order as they finish, so the file matches a serial export
+	for (size_t i = 0; i < chunkCount; i++) {
+		std::string chunk;
+		{
+			std::unique_lock<std::mutex> guard(readyLock);
+			chunkReady.wait(guard, [&]() { return ready[i] != 0; });
+			chunk.swap(chunks[i]);
 		}
+
+		outFile.write(chunk.data(), chunk.size());
 	}
 
-	// For each unit
-	for (int i = 0; i < unitInfo.size(); i++) {
-		// Try to find it's unit membership
-		auto unitMem = find(unitNames.begin(), unitNames.end(), unitInfo[i][2]);
+	for (std::thread& thread : workers)
+		thread.join();
+}
 
-		// If it belongs to a unit, add it's size to the unit's size
-		if (unitMem != unitNames.end())
-			unitSizes[std::distance(unitNames.begin(), unitMem)] += unitSizes[i];
+void output::logListsMD(const std::vector<character>& characterList, const std::vector<unit>& unitList, const std::vector<rosterString>& history, unsigned int threadCount) {
+	// Write the characters, then the units
+	logListMD("characterMD.md", characterList, history, threadCount);
+	logListMD("unitMD.md", unitList, history, threadCount);
+}
 
-		unitDets[i][1] = std::to_string(unitSizes[i]);
-	}
+// Write text as a quoted JSON string
+void writeJSON(support::outputSink& out, std::string_view text) {
+	static const char hex[] = "0123456789abcdef";
+	out << '"';
+
+	// Copy runs of plain characters whole, escaping only quotes, backslashes and control characters
+	size_t start = 0;
+	for (size_t i = 0; i < text.size(); i++) {
+		unsigned char c = text[i];
+		if (c >= 0x20 && c != '"' && c != '\\')
+			continue;
 
-	// For each unit
-	for (int i = 0; i < unitList.size(); i++) {
-		// Try to find it's unit membership
-		auto unitMem = find(unitNames.begin(), unitNames.end(), unitList[i].name);
+		out << text.substr(start, i - start);
+		start = i + 1;
 
-		// If it doesn't belongs to a unit
-		if (unitList[i].member == "None") {
-			// Recusive print it and it's members
-			recPrint(unitList, characterList, unitDets, i, 0);
+		switch (c) {
+		case '"': out << "\\\""; break;
+		case '\\': out << "\\\\"; break;
+		case '\n': out << "\\n"; break;
+		case '\r': out << "\\r"; break;
+		case '\t': out << "\\t"; break;
+		default: out << "\\u00" << hex[c >> 4] << hex[c & 15]; break;
 		}
 	}
 
-	// Print a newline for spacing
-	std::cout << "\n";
+	out << text.substr(start) << '"';
 }
 
-void output::logListsMD(const std::vector<character>& characterList, const std::vector<unit>& unitList, const std::vector<std::string>& history) {
-	// Variables for output file
-	std::ofstream outFileChar("characterMD.md");
-
-	for (character chara : characterList) {
-		// Write the content from the character
-		outFileChar << "# " << chara.name << "\n";
-		outFileChar << chara.output();
+// Write a rank's name as JSON, or null past the known ranks
+void writeJSONRank(support::outputSink& out, const std::vector<std::string>& ranks, int rank) {
+	if (rank >= 0 && size_t(rank) < ranks.size())
+		writeJSON(out, ranks[rank]);
+	else
+		out << "null";
+}
 
-		if (chara.historyIndex != -1)
-			outFileChar << history[chara.historyIndex];
+// Write the fields every entity shares
+void writeJSONEntity(support::outputSink& out, const entity& ent, const char* type, const std::vector<std::string>& ranks) {
+	out << "{\"type\":\"" << type << "\",\"name\":";
+	writeJSON(out, ent.name.str());
+	out << ",\"rank\":";
+	writeJSONRank(out, ranks, ent.rank);
+	// Belonging to no unit is written as null
+	out << ",\"member\":";
+	if (ent.member == symbol::none)
+		out << "null";
+	else
+		writeJSON(out, ent.member.str());
+
+	out << ",\"aspects\":[";
+	for (size_t i = 0; i < ent.aspects.size(); i++) {
+		if (i > 0)
+			out << ',';
+		writeJSON(out, ent.aspects[i]);
 	}
+	out << ']';
+}
 
-	// Close the Out File
-	outFileChar.close();
+// Write an entity's line of the NDJSON export
+void writeNDJSON(support::outputSink& out, const character& chara, const std::vector<rosterString>& history) {
+	writeJSONEntity(out, chara, "character", CharacterList.ranks);
+
+	out << ",\"relations\":[";
+	for (size_t i = 0; i < chara.relations.size(); i++) {
+		const entity::tagFeature& relation = chara.relations[i];
+
+		out << (i > 0 ? ",{\"name\":" : "{\"name\":");
+		writeJSON(out, relation.name.str());
+		out << ",\"tags\":[";
+		for (size_t j = 0; j < relation.tags.size(); j++) {
+			if (j > 0)
+				out << ',';
+			writeJSON(out, relation.tags[j]);
+		}
+		out << "],\"description\":";
+		writeJSON(out, relation.desc);
+		out << '}';
+	}
 
-	// Variables for output file
-	std::ofstream outFileUnit("unitMD.md");
+	// Split the history into its notes, one per line
+	out << "],\"history\":[";
+	if (chara.historyIndex >= 0 && size_t(chara.historyIndex) < history.size()) {
+		std::string_view notes = history[chara.historyIndex];
+		bool first = true;
 
-	for (unit unit : unitList) {
+		while (!notes.empty()) {
+			size_t end = std::min(notes.find('\n'), notes.size());
+			if (!first)
+				out << ',';
+			writeJSON(out, notes.substr(0, end));
 
-		// Write the content from the unit
-		outFileUnit << "# " << unit.name << "\n";
-		outFileUnit << unit.output();
+			notes.remove_prefix(std::min(end + 1, notes.size()));
+			first = false;
+		}
 	}
+	out << "]}\n";
+}
+
+void writeNDJSON(support::outputSink& out, const unit& uni, const std::vector<rosterString>&) {
+	writeJSONEntity(out, uni, "unit", GroupList.ranks);
+	out << "}\n";
+}
 
-	// Close the Out File
-	outFileUnit.close();
+void output::logListsNDJSON(const std::vector<character>& characterList, const std::vector<unit>& unitList, const std::vector<rosterString>& history) {
+	// Stream each entity straight from the lists through a fixed-size buffer
+	std::ofstream outFile("roster.ndjson", std::ios::binary);
+	support::outputSink out(outFile);
+
+	for (const character& chara : characterList)
+		writeNDJSON(out, chara, history);
+	for (const unit& uni : unitList)
+		writeNDJSON(out, uni, history);
 }
 
 void output::multiPrint(const std::vector<character>& characterList, const std::vector<unit>& unitList) {
@@ -245,6 +361,8 @@ void output::multiPrint(const std::vector<character>& characterList, const std::
 	}
 
 	// Based on the entity being printed
+	support::outputSink out(std::cout);
+
 	switch (entType) {
 	case 1:
 	{
@@ -275,11 +393,11 @@ void output::multiPrint(const std::vector<character>& characterList, const std::
 		}
 
 		// Print all marked characters
-		std::cout << "Characters" << "\n";
+		out << "Characters" << "\n";
 		for (int i = 0; i < characterList.size(); i++) {
 			if (arr[i]) {
-				std::cout << characterList[i].output();
-				std::cout << "\n";
+				characterList[i].output(out);
+				out << "\n";
 			}
 			
 		}
@@ -314,11 +432,11 @@ void output::multiPrint(const std::vector<character>& characterList, const std::
 		}
 
 		// Print all marked units
-		std::cout << "Units" << "\n";
+		out << "Units" << "\n";
 		for (int i = 0; i < unitList.size(); i++) {
 			if (arr[i]) {
-				std::cout << unitList[i].output();
-				std::cout << "\n";
+				unitList[i].output(out);
+				out << "\n";
 			}
 
 		}
@@ -328,70 +446,112 @@ void output::multiPrint(const std::vector<character>& characterList, const std::
 	}
 }
 
+void output::printTagged(const std::vector<character>& characterList, const std::vector<unit>& unitList) {
+	// Look up the relations by tag
+	tagIndex scratch;
+	const tagIndex& index = simpleFind::tags(characterList, scratch);
+
+	std::vector<symbol> tags = index.tags();
+	if (tags.empty()) {
+		std::cout << "No relations are tagged.\n\n";
+		return;
+	}
+
+	// Prompt for the tag
+	std::vector<std::string> tagNames;
+	for (const symbol& tag : tags)
+		tagNames.push_back(tag.str());
+
+	symbol tag = tags[support::prompt("Which Tag?", tagNames) - 1];
+
+	// Prompt for a unit to limit the targets to
+	unitAncestors treeScratch;
+	const unitAncestors& tree = simpleFind::ancestors(unitList, treeScratch);
+	int unitInd = -1;
+
+	if (!unitList.empty() && support::prompt("Only Relations Towards A Unit?", { "Yes", "No" }) == 1) {
+		std::vector<std::string> unitNames;
+		for (const unit& uni : unitList)
+			unitNames.push_back(uni.name.str());
+
+		unitInd = support::prompt("Which Unit?", unitNames) - 1;
+	}
+
+	// Print each relation carrying the tag, skipping targets outside the unit
+	support::outputSink out(std::cout);
+
+	out << "Relations Tagged " << tag << "\n";
+	for (const tagIndex::posting& post : index.tagged(tag)) {
+		if (unitInd != -1) {
+			int target = simpleFind::find(characterList, post.target);
+			if (target == -1)
+				continue;
+
+			int memberInd = tree.find(characterList[target].member);
+			if (memberInd == -1 || (memberInd != unitInd && !tree.isUnder(memberInd, unitInd)))
+				continue;
+		}
+
+		out << characterList[post.source].name << " -> " << post.target << ": " << characterList[post.source].relations[post.relation].desc << "\n";
+	}
+
+	out << "\n";
+}
+
 void output::charPrintFull(const character& acter, const std::vector<unit>& unitList) {
+	support::outputSink out(std::cout);
+
 	// If not a member, simply print
-	if (acter.member == "None")
-		std::cout << acter.output();
+	if (acter.member == symbol::none)
+		acter.output(out);
 	else {
 		// Print Name and Rank
-		std::cout << "Name: " << acter.name << "\n";
-		std::cout << "Rank: " << CharacterList.ranks[acter.rank] << "\n";
+		out << "Name: " << acter.name << "\n";
+		out << "Rank: " << CharacterList.ranks[acter.rank] << "\n";
 
 		// Record the character's aspects and relations
-		std::vector<std::string> fullAspects = acter.aspects;
+		std::vector<std::string> fullAspects(acter.aspects.begin(), acter.aspects.end());
 		std::vector<std::vector<std::string>> fullRelations;
-		for (entity::tagFeature rel : acter.relations) {
+		for (const entity::tagFeature& rel : acter.relations) {
 			std::vector<std::string> relString;
-			relString.push_back(rel.name);
-			for (std::string tag : rel.tags)
-				relString.push_back(tag);
-			relString.push_back(rel.desc);
+			relString.push_back(rel.name.str());
+			for (const rosterString& tag : rel.tags)
+				relString.emplace_back(tag);
+			relString.emplace_back(rel.desc);
 			fullRelations.push_back(relString);
 		}
 
-		// Set next member and initilize the full member vector
-		std::vector<std::string> fullMember;
-		std::string nextMember = acter.member;
-
-		// While a next member exists
-		while (nextMember != "None") {
+		// Find the unit the character belongs to and every unit above it
+		unitAncestors scratch;
+		const unitAncestors& tree = simpleFind::ancestors(unitList, scratch);
 
-			// Check if the member exists
-			if (simpleFind::find(unitList, nextMember) == -1)
-				break;
+		std::vector<symbol> fullMember;
+		int unitInd = tree.find(acter.member);
 
+		if (unitInd != -1) {
+			std::vector<int> chain = tree.ancestors(unitInd);
+			chain.insert(chain.begin(), unitInd);
 
-			// Find the unit the entity belongs to
-			for (unit unit : unitList) {
-				if (unit.name == nextMember) {
-					// Add the aspects, relations and membership
-					fullAspects.insert(fullAspects.end(), unit.aspects.begin(), unit.aspects.end());
-					fullMember.push_back(nextMember);
-					std::vector<std::vector<std::string>> newRelations;
-					fullRelations.insert(fullRelations.end(), newRelations.begin(), newRelations.end());
-
-					// Update the next member, while preventing an infinte loop
-					if (nextMember != unit.member)
-						nextMember = unit.member;
-					else
-						nextMember = "None";
-
-					break;
-				}
+			// Add the aspects and membership of each unit
+			for (int pos : chain) {
+				fullAspects.insert(fullAspects.end(), unitList[pos].aspects.begin(), unitList[pos].aspects.end());
+				fullMember.push_back(unitList[pos].name);
 			}
 		}
+		else
+			fullMember.push_back(acter.member);
 
 		// Print the full memberships, aspects and relations
-		std::cout << "Member: ";
-		for (std::string membership : std::vector<std::string>(fullMember.begin(), fullMember.end() - 1))
-			std::cout << membership << " - ";
-		std::cout << fullMember.back() << "\n";
+		out << "Member: ";
+		for (size_t i = 0; i + 1 < fullMember.size(); i++)
+			out << fullMember[i] << " - ";
+		out << fullMember.back() << "\n";
 
-		for (std::string aspect : fullAspects)
-			std::cout << "Aspect: " << aspect << "\n";
+		for (const std::string& aspect : fullAspects)
+			out << "Aspect: " << aspect << "\n";
 
-		for (std::vector<std::string> relation : fullRelations)
-			std::cout << "Relation: " << relation[0] << " - " << relation[1] << "\n";
+		for (const std::vector<std::string>& relation : fullRelations)
+			out << "Relation: " << relation[0] << " - " << relation[1] << "\n";
 	}
 }
 
@@ -401,65 +561,123 @@ void output::charPrintFull(const character& acter, const std::vector<unit>& unit
 */
 
 std::vector<std::string> input::splitDelim(std::string input) {
-	// Prepare the standard delim list
-	std::vector<std::string> delimList = { ": ", " - ", " < "," > ", "> " , " <" };
-
-	// Pass and return
-	return splitDelim(input, delimList);
+	return support::splitByDelim(input);
 }
 
 std::vector<std::string> input::splitDelim(std::string input, std::vector<std::string> delimList) {
-	// Variables for delims found position and tracking progress
-	std::vector<int> delimPos;
-	bool isRunning = true;
-
-	// Variable for the return
-	std::vector<std::string> splitLine;
-
-	// Split until a delim cannot be found
-	while (isRunning) {
-		// Find each delim in the string
-		for (std::string delim : delimList) {
-			// Find the delim
-			int relPos = input.find(delim);
-
-			// If the delim doesn't appear, set it to the array's size
-			if (relPos == -1)
-				delimPos.push_back(input.size());
-			else
-				delimPos.push_back(input.find(delim));
-		}
+	return support::splitByDelim(input, delimList);
+}
 
-		// Determine the first delim to appear
-		auto minEleIter = std::min_element(delimPos.begin(), delimPos.end());
-		int minEle = std::distance(delimPos.begin(), minEleIter);
+void input::splitDelim(std::string_view input, std::vector<std::string_view>& parts) {
+	support::splitByDelim(input, parts);
+}
 
-		// If no delim's appeared, break
-		if (delimPos[minEle] == input.size()){
-			isRunning = false;
-			break;
-		}
+void input::splitDelim(std::string_view input, const support::delimSplitter& delims, std::vector<std::string_view>& parts) {
+	support::splitByDelim(input, delims, parts);
+}
 
-		// Split the line and continue with the remainder
-		splitLine.push_back(input.substr(0, input.find(delimList[minEle])));
-		input = input.substr(input.find(delimList[minEle]) + delimList[minEle].size());
+// Call lineFunc on each line of a mapped file, matching getline's splitting
+template <typename Func>
+void forEachLine(std::string_view contents, Func lineFunc) {
+	while (!contents.empty()) {
+		// Cut the line at the next newline, or the end of the file
+		size_t lineEnd = contents.find('\n');
+		std::string_view line = contents.substr(0, lineEnd);
 
-		// Clear the delim positions
-		delimPos.clear();
+		if (lineEnd == std::string_view::npos)
+			contents = {};
+		else
+			contents.remove_prefix(lineEnd + 1);
+
+		// Drop the carriage return of a Windows line ending
+		if (!line.empty() && line.back() == '\r')
+			line.remove_suffix(1);
+
+		lineFunc(line);
 	}
+}
 
-	// Add the rest of the line to the return
-	splitLine.push_back(input);
+// Add a line to a parsed character, collecting its history
+void parseLine(character& chara, std::string_view line, std::vector<rosterString>& history) {
+	chara.addFeature(line, history);
+}
 
-	return splitLine;
+// Add a line to a parsed unit
+void parseLine(unit& uni, std::string_view line, std::vector<rosterString>&) {
+	uni.addFeature(line);
 }
 
-void input::loadChar(std::string file, std::vector<character>& characterList, std::vector<std::string>& history) {
+// Keep a parsed entity by moving it and its history into the lists, then reset it
+// The entity was parsed straight into the roster arena, so the move only hands its text over
+template <typename T>
+void keepParsed(T& parsed, std::vector<rosterString>& parsedHistory, std::vector<T>& list, std::vector<rosterString>& history) {
+	T& ent = list.emplace_back(std::move(parsed));
+
+	if constexpr (std::is_same_v<T, character>) {
+		if (ent.historyIndex != -1) {
+			history.push_back(std::move(parsedHistory[ent.historyIndex]));
+			ent.historyIndex = history.size() - 1;
+		}
+	}
+
+	parsed = T(&RosterArena);
+	parsedHistory.clear();
+}
+
+// Stream a markdown file holding an entity per `# ` header, keeping each entity as its section ends
+// Only the reader's chunk and the entity being parsed are held, however large the file
+template <typename T>
+void streamMarkdown(const std::string& path, const symbol& source, std::vector<T>& list, std::vector<rosterString>& history) {
+	// Bytes to read before estimating the file's entity count
+	const uint64_t estimateAfter = 1 << 20;
+
+	support::lineReader reader(path);
+	std::string_view line;
+
+	T parsed(&RosterArena);
+	std::vector<rosterString> parsedHistory;
+	bool parsing = false;
+
+	// Note where the file's entities and history start, for the estimate
+	size_t firstEntity = list.size(), firstHistory = history.size();
+	bool reserved = false;
+
+	while (reader.next(line)) {
+		// If the header delim appears, keep the previous entity and start another
+		size_t findPos = line.find("# ");
+		if (findPos != std::string_view::npos) {
+			if (parsing)
+				keepParsed(parsed, parsedHistory, list, history);
+
+			// Once enough has been read, reserve for the rest of the file at the same density
+			if (!reserved && reader.consumed() >= estimateAfter) {
+				double remaining = double(reader.size() - reader.consumed()) / reader.consumed();
+				list.reserve(list.size() + size_t((list.size() - firstEntity) * remaining));
+				history.reserve(history.size() + size_t((history.size() - firstHistory) * remaining));
+				reserved = true;
+			}
+
+			parsing = true;
+			parsed.name = symbol(line.substr(findPos + 2));
+			parsed.source = source;
+			continue;
+		}
+
+		// Attempt to add a feature to the current entity
+		if (parsing)
+			parseLine(parsed, line, parsedHistory);
+	}
+
+	if (parsing)
+		keepParsed(parsed, parsedHistory, list, history);
+}
+
+void input::loadChar(std::string file, std::vector<character>& characterList, std::vector<rosterString>& history) {
 	// Text file loading lambda
 	auto loadCharTXT = [&]() {
 		// Add the character to the character list
 		int charIn = characterList.size();
-		characterList.push_back(character());
+		characterList.emplace_back(&RosterArena);
 
 		// Access the character's file
 		std::ifstream inputFile;
@@ -472,40 +690,15 @@ void input::loadChar(std::string file, std::vector<character>& characterList, st
 			characterList[charIn].addFeature(line, history);
 		}
 
-		// Add the character's name
-		characterList[charIn].name = file.substr(0, file.find("."));
+		// Add the character's name and file
+		characterList[charIn].name = symbol(file.substr(0, file.find(".")));
+		characterList[charIn].source = symbol(file);
 	};
 
 	// Markdown file loading lambda
 	auto loadCharMD = [&]() {
-		// Access the character markdown file
-		std::ifstream inputFile;
-		inputFile.open("Characters/" + file);
-
-		// Initialize current character index
-		int charIn = -1;
-
-		// For each line
-		std::string line;
-		while (getline(inputFile, line)) {
-			// Search for the header delim
-			int findPos = line.find("# ");
-
-			// If the delim appears, add a character and index it
-			if (findPos != -1) {
-				charIn = characterList.size();
-				characterList.push_back(character());
-				characterList[charIn].name = line.substr(findPos + 2);
-				continue;
-			}
-
-			// If no character is indexed, skip
-			if (charIn == -1)
-				continue;
-
-			// Attempt to add a festure
-			characterList[charIn].addFeature(line, history);
-		}
+		// Stream the character markdown file
+		streamMarkdown("Characters/" + file, symbol(file), characterList, history);
 	};
 
 	// Skip the template
@@ -521,12 +714,12 @@ void input::loadChar(std::string file, std::vector<character>& characterList, st
 		loadCharMD();
 }
 
-void input::loadUnit(std::string file, std::vector<unit>& unitList, std::vector<std::string>& history) {
+void input::loadUnit(std::string file, std::vector<unit>& unitList, std::vector<rosterString>& history) {
 	// Text file loading lambda
 	auto loadUnitTXT = [&]() {
 		// Add the unit to the unit list
 		int unitIn = unitList.size();
-		unitList.push_back(unit());
+		unitList.emplace_back(&RosterArena);
 
 		// Access the unit's file
 		std::ifstream inputFile;
@@ -539,40 +732,15 @@ void input::loadUnit(std::string file, std::vector<unit>& unitList, std::vector<
 			unitList[unitIn].addFeature(line);
 		}
 
-		// Add the unit's name
-		unitList[unitIn].name = file.substr(0, file.find("."));
+		// Add the unit's name and file
+		unitList[unitIn].name = symbol(file.substr(0, file.find(".")));
+		unitList[unitIn].source = symbol(file);
 	};
 
 	// Markdown file loading lambda
 	auto loadUnitMD = [&]() {
-		// Access the unit markdown file
-		std::ifstream inputFile;
-		inputFile.open("Units/" + file);
-
-		// Initialize current unit index
-		int unitIn = -1;
-
-		// For each line
-		std::string line;
-		while (getline(inputFile, line)) {
-			// Search for the header delim
-			int findPos = line.find("# ");
-
-			// If the delim appears, add a unit and index it
-			if (findPos != -1) {
-				unitIn = unitList.size();
-				unitList.push_back(unit());
-				unitList[unitIn].name = line.substr(findPos + 2);
-				continue;
-			}
-
-			// If no unit is indexed, skip
-			if (unitIn == -1)
-				continue;
-
-			// Attempt to add a festure
-			unitList[unitIn].addFeature(line);
-		}
+		// Stream the unit markdown file
+		streamMarkdown("Units/" + file, symbol(file), unitList, history);
 	};
 
 	// Skip the template
@@ -586,4 +754,163 @@ void input::loadUnit(std::string file, std::vector<unit>& unitList, std::vector<
 	// Check and add if the file is .md
 	if (file.substr(file.find(".")) == ".md")
 		loadUnitMD();
-}
\ No newline at end of file
+}
+
+// Load a text or markdown entity file from a directory, skipping its template
+// A text file is memory mapped unless mapped is false, when it is read in chunks instead
+template <typename T>
+void loadMapped(const std::string& dir, const std::string& templateName, const std::string& file, std::vector<T>& list, std::vector<rosterString>& history, bool mapped = true) {
+	// Skip the template
+	if (file.substr(0, file.find(".")) == templateName)
+		return;
+
+	// Only load text and markdown files
+	std::string extension = file.substr(file.find("."));
+	if (extension != ".txt" && extension != ".md")
+		return;
+
+	// Text file: a single entity named after the file, mapped since it is small
+	if (extension == ".txt") {
+		T parsed(&RosterArena);
+		std::vector<rosterString> parsedHistory;
+
+		// Map or read the entity's file, an unreadable file loads as empty
+		if (mapped) {
+			support::mappedFile contents(dir + "/" + file);
+
+			forEachLine(contents.view(), [&](std::string_view line) {
+				parseLine(parsed, line, parsedHistory);
+			});
+		}
+		else {
+			support::lineReader reader(dir + "/" + file);
+			std::string_view line;
+
+			while (reader.next(line))
+				parseLine(parsed, line, parsedHistory);
+		}
+
+		parsed.name = symbol(file.substr(0, file.find(".")));
+		parsed.source = symbol(file);
+		keepParsed(parsed, parsedHistory, list, history);
+	}
+	// Markdown file: an entity per `# ` header, streamed since it may be large
+	else
+		streamMarkdown(dir + "/" + file, symbol(file), list, history);
+}
+
+void input::loadCharMapped(std::string file, std::vector<character>& characterList, std::vector<rosterString>& history) {
+	loadMapped<character>("Characters", "Template Character", file, characterList, history);
+}
+
+void input::loadUnitMapped(std::string file, std::vector<unit>& unitList, std::vector<rosterString>& history) {
+	loadMapped<unit>("Units", "Template Unit", file, unitList, history);
+}
+
+void input::loadCharRead(std::string file, std::vector<character>& characterList, std::vector<rosterString>& history) {
+	loadMapped<character>("Characters", "Template Character", file, characterList, history, false);
+}
+
+void input::loadUnitRead(std::string file, std::vector<unit>& unitList, std::vector<rosterString>& history) {
+	loadMapped<unit>("Units", "Template Unit", file, unitList, history, false);
+}
+
+// Load each file into its own buffer across threads, then merge the buffers in file order
+// A file that fails to load is reported and skipped, leaving the rest of the roster loaded
+template <typename T>
+void loadFiles(const std::string& dir, const std::vector<std::string>& files, std::vector<T>& list, std::vector<rosterString>& history, unsigned int threadCount,
+	void (*loadFile)(std::string, std::vector<T>&, std::vector<rosterString>&)) {
+	// Per-file buffer for the loaded entities, their history and whether the load failed
+	struct loadSlot {
+		std::vector<T> entities;
+		std::vector<rosterString> history;
+		bool failed = false;
+	};
+
+	// Bound the threads by the number of files
+	threadCount = std::min<unsigned int>(threadCount, files.size());
+
+	// If only one thread is usable, load directly into the list
+	if (threadCount <= 1) {
+		for (const std::string& file : files) {
+			size_t entityCount = list.size(), historyCount = history.size();
+
+			try {
+				loadFile(file, list, history);
+			}
+			catch (...) {
+				// Drop whatever the file loaded before it failed
+				list.erase(list.begin() + entityCount, list.end());
+				history.erase(history.begin() + historyCount, history.end());
+				std::cout << "Unable to load " << dir << "/" << file << "\n";
+			}
+		}
+		return;
+	}
+
+	// Prepare a buffer for every file and a shared counter of the next file
+	std::vector<loadSlot> slots(files.size());
+	std::atomic<size_t> nextFile = 0;
+
+	// Each worker claims the next unloaded file until none remain
+	auto worker = [&]() {
+		for (size_t i = nextFile++; i < files.size(); i = nextFile++) {
+			try {
+				loadFile(files[i], slots[i].entities, slots[i].history);
+			}
+			catch (...) {
+				slots[i].failed = true;
+			}
+		}
+	};
+
+	// Run the workers and wait for them to finish
+	std::vector<std::thread> workers;
+	for (unsigned int i = 0; i < threadCount; i++)
+		workers.emplace_back(worker);
+	for (std::thread& thread : workers)
+		thread.join();
+
+	// Size the list and history once for every buffer
+	size_t entityCount = list.size(), historyCount = history.size();
+	for (const loadSlot& slot : slots) {
+		entityCount += slot.entities.size();
+		historyCount += slot.history.size();
+	}
+
+	list.reserve(entityCount);
+	history.reserve(historyCount);
+
+	// Merge the buffers in file order, so the result matches a serial load
+	for (size_t i = 0; i < slots.size(); i++) {
+		loadSlot& slot = slots[i];
+
+		// Report failures in the same order a serial load would
+		if (slot.failed) {
+			std::cout << "Unable to load " << dir << "/" << files[i] << "\n";
+			continue;
+		}
+
+		// Shift history indices past the history already merged
+		int historyOffset = history.size();
+
+		for (T& ent : slot.entities) {
+			if constexpr (std::is_same_v<T, character>) {
+				if (ent.historyIndex != -1)
+					ent.historyIndex += historyOffset;
+			}
+			list.push_back(std::move(ent));
+		}
+
+		for (rosterString& entry : slot.history)
+			history.push_back(std::move(entry));
+	}
+}
+
+void input::loadCharFiles(const std::vector<std::string>& files, std::vector<character>& characterList, std::vector<rosterString>& history, unsigned int threadCount) {
+	loadFiles<character>("Characters", files, characterList, history, threadCount, input::loadCharMapped);
+}
+
+void input::loadUnitFiles(const std::vector<std::string>& files, std::vector<unit>& unitList, std::vector<rosterString>& history, unsigned int threadCount) {
+	loadFiles<unit>("Units", files, unitList, history, threadCount, input::loadUnitMapped);
+}
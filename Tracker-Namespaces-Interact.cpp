@@ -4,167 +4,312 @@
 	Interaction Scripts
 */
 
-std::set<std::string> interactions::verifyMemberships(std::vector<character> characterList, std::vector<unit> unitList) {
-	// Variables
-	std::vector<std::string> unitNames = {"None"};
-	std::set<std::string> returnList;
+// Validate two lists, leaving out the rows for which the skip functions hold
+template <typename CharSkip, typename UnitSkip>
+std::vector<diagnostic> validateRows(const std::vector<character>& characterList, const std::vector<unit>& unitList, unsigned int threadCount,
+	CharSkip skipChar, UnitSkip skipUnit) {
+	// Rosters smaller than this are checked on a single thread
+	const size_t parallelAfter = 1 << 14;
 
-	// Append all unit names to unitNames
-	for (unit unit : unitList) {
-		unitNames.push_back(unit.name);
-	}
+	std::vector<diagnostic> diagnostics;
 
-	// For each character
-	for (character character : characterList) {
-		// If the member's name can't be found in unitNames, report it
-		if (find(unitNames.begin(), unitNames.end(), character.member) == unitNames.end())
-			returnList.insert(character.member);
-	}
+	// Hash the known names, reporting a name each time it repeats
+	std::unordered_set<symbol> charNames, unitNames;
+	charNames.reserve(characterList.size());
+	unitNames.reserve(unitList.size() + 1);
+
+	for (size_t i = 0; i < characterList.size(); i++)
+		if (!skipChar(i) && !charNames.insert(characterList[i].name).second)
+			diagnostics.push_back({ diagnostic::duplicateName, characterList[i].name, false, "Name", characterList[i].name });
+
+	for (size_t i = 0; i < unitList.size(); i++)
+		if (!skipUnit(i) && !unitNames.insert(unitList[i].name).second)
+			diagnostics.push_back({ diagnostic::duplicateName, unitList[i].name, true, "Name", unitList[i].name });
+
+	// Belonging to no unit is always valid
+	unitNames.insert(symbol::none);
+
+	// Check a range of rows, characters first and units after
+	auto checkRows = [&](size_t first, size_t last, std::vector<diagnostic>& found) {
+		for (size_t row = first; row < last; row++) {
+			if (row < characterList.size()) {
+				if (skipChar(row))
+					continue;
+
+				const character& chara = characterList[row];
 
-	// For each unit
-	for (unit unit : unitList) {
-		// If the member's name can't be found in unitNames, report it
-		if (find(unitNames.begin(), unitNames.end(), unit.member) == unitNames.end())
-			returnList.insert(unit.member);
+				// Report a missing unit membership
+				if (unitNames.count(chara.member) == 0)
+					found.push_back({ diagnostic::missingUnit, chara.name, false, "Member", chara.member });
+
+				// Report each missing relation
+				for (const entity::tagFeature& relation : chara.relations)
+					if (charNames.count(relation.name) == 0)
+						found.push_back({ diagnostic::missingCharacter, chara.name, false, "Relation", relation.name });
+			}
+			else {
+				if (skipUnit(row - characterList.size()))
+					continue;
+
+				const unit& uni = unitList[row - characterList.size()];
+
+				// Report a unit belonging to itself or to a missing unit
+				if (uni.member == uni.name)
+					found.push_back({ diagnostic::selfMembership, uni.name, true, "Member", uni.member });
+				else if (unitNames.count(uni.member) == 0)
+					found.push_back({ diagnostic::missingUnit, uni.name, true, "Member", uni.member });
+			}
+		}
+	};
+
+	// Split the rows evenly across the threads of a large roster
+	size_t rows = characterList.size() + unitList.size();
+	if (rows < parallelAfter)
+		threadCount = 1;
+	threadCount = std::max(1u, threadCount);
+
+	std::vector<std::vector<diagnostic>> found(threadCount);
+
+	if (threadCount == 1)
+		checkRows(0, rows, found[0]);
+	else {
+		std::vector<std::thread> workers;
+		for (unsigned int i = 0; i < threadCount; i++)
+			workers.emplace_back(checkRows, rows * i / threadCount, rows * (i + 1) / threadCount, std::ref(found[i]));
+		for (std::thread& thread : workers)
+			thread.join();
 	}
 
+	// Join the ranges in row order
+	for (const std::vector<diagnostic>& part : found)
+		diagnostics.insert(diagnostics.end(), part.begin(), part.end());
+
+	return diagnostics;
+}
+
+std::vector<diagnostic> interactions::validate(const std::vector<character>& characterList, const std::vector<unit>& unitList, unsigned int threadCount) {
+	auto keep = [](size_t) { return false; };
+	return validateRows(characterList, unitList, threadCount, keep, keep);
+}
+
+std::vector<diagnostic> interactions::validate(const entityStore<character>& charStore, const entityStore<unit>& unitStore, unsigned int threadCount) {
+	return validateRows(charStore.entities(), unitStore.entities(), threadCount,
+		[&](size_t i) { return charStore.removed(i); }, [&](size_t i) { return unitStore.removed(i); });
+}
+
+std::set<std::string> interactions::verifyMemberships(const std::vector<character>& characterList, const std::vector<unit>& unitList) {
+	std::set<std::string> returnList;
+
+	// Report each missing unit once
+	for (const diagnostic& diag : validate(characterList, unitList))
+		if (diag.problem == diagnostic::missingUnit)
+			returnList.insert(diag.value.str());
+
 	// Return the list
 	return returnList;
 }
 
-void interactions::verifySizes(std::vector<character> characterList, std::vector<unit> unitList) {
-	// Variables
-	std::vector<std::string> unitNames = {  };
-	std::vector<std::vector<std::string>> unitInfo = { };
-	std::vector<int> unitSizes = { };
+std::set<std::string> interactions::verifyRelations(const std::vector<character>& list) {
+	std::set<std::string> returnList;
+
+	// Report each missing character once
+	for (const diagnostic& diag : validate(list, {}))
+		if (diag.problem == diagnostic::missingCharacter)
+			returnList.insert(diag.value.str());
 
-	// Store the unit's name and necessary information and initialize the units' size
-	for (unit unit : unitList) {
-		unitInfo.push_back({ unit.name, std::to_string(unit.rank), unit.member });
-		unitSizes.push_back(0);
-	}
+	// Return the list
+	return returnList;
+}
 
-	// Sort unit info in order of rank integer
-	std::sort(unitInfo.begin(), unitInfo.end(),
-		[](std::vector<std::string> a, std::vector<std::string> b) {
-			return stoi(a[1]) < stoi(b[1]);
-		});
+void interactions::printProblems(const std::vector<diagnostic>& diagnostics) {
+	// Sort the problems, noting each name once
+	std::set<std::string> missingUnits, missingChars, selfMembers, repeatedChars, repeatedUnits;
 
-	// Store the unit's name via sorted order
-	for (std::vector<std::string> unit : unitInfo) {
-		unitNames.push_back(unit[0]);
+	for (const diagnostic& diag : diagnostics) {
+		switch (diag.problem) {
+		case diagnostic::missingUnit:
+			missingUnits.insert(diag.value.str());
+			break;
+		case diagnostic::missingCharacter:
+			missingChars.insert(diag.value.str());
+			break;
+		case diagnostic::selfMembership:
+			selfMembers.insert(diag.entity.str());
+			break;
+		case diagnostic::duplicateName:
+			if (diag.unitEntity)
+				repeatedUnits.insert(diag.entity.str());
+			else
+				repeatedChars.insert(diag.entity.str());
+			break;
+		}
 	}
 
-	// For each character
-	for (character character : characterList) {
-		// Try to find it's unit membership
-		auto charMem = find(unitNames.begin(), unitNames.end(), character.member);
+	// Report any missing entities
+	for (const std::string& unitName : missingUnits)
+		std::cout << "The unit " << unitName << " cannot be found\n";
 
-		// If it belongs to a unit, add to the unit's size
-		if (charMem != unitNames.end())
-			unitSizes[std::distance(unitNames.begin(), charMem)] += 1;
+	for (const std::string& charName : missingChars)
+		std::cout << "The character " << charName << " cannot be found\n";
+
+	// Report any other problems
+	for (const std::string& unitName : selfMembers)
+		std::cout << "The unit " << unitName << " is a member of itself\n";
+
+	for (const std::string& charName : repeatedChars)
+		std::cout << "The character " << charName << " is named more than once\n";
+
+	for (const std::string& unitName : repeatedUnits)
+		std::cout << "The unit " << unitName << " is named more than once\n";
+}
+
+void interactions::markEdited(const std::vector<character>& arr, const symbol& name) {
+	if (CharacterList.holds(arr)) {
+		RosterValidation.markDirty(name);
+
+		int position = simpleFind::find(arr, name);
+		RosterTags.update(arr, position);
+		if (position != -1)
+			RosterRanks.updateCharacter(position, arr[position].rank);
 	}
+}
 
-	// For each unit
-	for (int i = 0; i < unitInfo.size(); i++) {
-		// Try to find it's unit membership
-		auto unitMem = find(unitNames.begin(), unitNames.end(), unitInfo[i][2]);
+void interactions::markEdited(const std::vector<unit>& arr, const symbol& name) {
+	if (GroupList.holds(arr)) {
+		RosterValidation.markDirty(name);
 
-		// If it belongs to a unit, add it's size to the unit's size
-		if (unitMem != unitNames.end())
-			unitSizes[std::distance(unitNames.begin(), unitMem)] += unitSizes[i];
+		int position = simpleFind::find(arr, name);
+		if (position != -1)
+			RosterRanks.updateUnit(position, arr[position].rank);
+	}
+}
 
-		// Print out the size
-		std::cout << "[" << GroupList.ranks[stoi(unitInfo[i][1])] << "] " << unitNames[i] << ": Size " << unitSizes[i] << ".";
+void interactions::markMoved(const std::vector<character>& arr, int position, const symbol& from) {
+	if (CharacterList.holds(arr)) {
+		RosterValidation.markDirty(arr[position].name);
+		RosterHierarchy.moveCharacter(position, from, arr[position].member);
+		RosterSizes.moveCharacter(RosterAncestors, from, arr[position].member);
+		RosterTags.update(arr, position);
+		RosterRanks.updateCharacter(position, arr[position].rank);
+	}
+}
 
-		// If the size is invalid, report it
-		if (!(pow(2, stoi(unitInfo[i][1])) <= unitSizes[i] && unitSizes[i] <= (3 * pow(2, stoi(unitInfo[i][1]) - 1))))
-			std::cout << " Invalid Size";
-		
-		std::cout << "\n";
+void interactions::markMoved(const std::vector<unit>& arr, int position, const symbol&) {
+	if (GroupList.holds(arr)) {
+		RosterValidation.markDirty(arr[position].name);
+		RosterAncestors.invalidate();
+		RosterSizes.invalidate();
+		RosterRanks.updateUnit(position, arr[position].rank);
 	}
 }
 
-std::set<std::string> interactions::verifyRelations(std::vector<character> list) {
-	// Variables
-	std::vector<std::string> charNames;
-	std::set<std::string> returnList;
+void interactions::markAdded(const std::vector<character>& arr, int position) {
+	if (CharacterList.holds(arr)) {
+		const character& chara = arr[position];
 
-	// Append all character names to charNames
-	for (character character : list) {
-		charNames.push_back(character.name);
+		RosterValidation.markDirty(chara.name);
+		RosterHierarchy.addCharacter(position, chara.member);
+		RosterSizes.addCharacter(RosterAncestors, position, chara.member);
+		RosterTags.insert(arr, position);
+		RosterRanks.addCharacter(position, chara.rank);
 	}
+}
 
-	// For each character
-	for (character character : list) {
-		// For each relation
-		for (entity::tagFeature member : character.relations) {
-			// If the member's name can't be found in charNames, add it to the return
-			if (find(charNames.begin(), charNames.end(), member.name) == charNames.end())
-				returnList.insert(member.name);
-		}
+void interactions::markAdded(const std::vector<unit>& arr, int position) {
+	if (GroupList.holds(arr)) {
+		RosterValidation.markDirty(arr[position].name);
+		RosterAncestors.invalidate();
+		RosterSizes.invalidate();
+		RosterRanks.addUnit(position, arr[position].rank);
 	}
+}
 
-	// Return the list
-	return returnList;
+void interactions::markRemoved(const std::vector<character>& arr, int position) {
+	if (CharacterList.holds(arr)) {
+		RosterValidation.markDirty(arr[position].name);
+		RosterHierarchy.removeCharacter(position, arr[position].member);
+		RosterSizes.removeCharacter(RosterAncestors, arr[position].member);
+		RosterTags.remove(position);
+		RosterRanks.removeCharacter(position);
+	}
+}
+
+void interactions::markRemoved(const std::vector<unit>& arr, int position) {
+	if (GroupList.holds(arr)) {
+		RosterValidation.markDirty(arr[position].name);
+		RosterAncestors.invalidate();
+		RosterSizes.invalidate();
+		RosterRanks.removeUnit(position);
+	}
 }
 
-void interactions::writeToFile(std::vector<character> characterList, std::vector<unit> unitList) {
-	for (character chara : characterList) {
-		// Variables for input file and spare contents
-		std::ifstream inFile("Characters/" + chara.name + ".txt");
-		std::string contents = "";
+void interactions::verifySizes(const std::vector<character>& characterList, const std::vector<unit>& unitList) {
+	// Count each unit's members bottom-up
+	unitSizes scratch;
+	const unitSizes& sizes = simpleFind::sizes(characterList, unitList, scratch);
+
+	// For each unit in order of rank integer
+	rankIndex scratchRanks;
+	const rankIndex& ranks = simpleFind::ranks(characterList, unitList, scratchRanks);
+
+	for (int rank = 0; rank < ranks.unitRanks(); rank++) {
+		for (int pos : ranks.units(rank)) {
+			int size = sizes.total(pos);
+
+			// Print out the size
+			std::cout << "[" << GroupList.ranks[rank] << "] " << unitList[pos].name << ": Size " << size << ".";
 
-		// For each line in the file
-		std::string line;
-		while (getline(inFile, line)) {
-			// if the string does not contain a `: `, save it for later
-			if (line.find(": ") == std::string::npos)
-				contents += line + "\n";
+			// If the size is invalid, report it
+			if (!unitSizes::fits(rank, size))
+				std::cout << " Invalid Size";
+
+			std::cout << "\n";
 		}
-		inFile.close();
-
-		// Reopen the file as an output file
-		std::ofstream outFile("Characters/" + chara.name + ".txt");
-
-		// Write the content from the character
-		outFile << "Rank: " << CharacterList.ranks[chara.rank] << "\n";
-		outFile << "Member: " << chara.member << "\n";
-		for (std::string aspect : chara.aspects)
-			outFile << "Aspect: " << aspect << "\n";
-		for (entity::tagFeature relation : chara.relations)
-			outFile << "Relation: " << relation.name << ": " << relation.desc << "\n";
-
-		// Rewrite the spare contents
-		outFile << contents;
-		outFile.close();
 	}
+}
 
-	for (unit unit : unitList) {
-		// Variables for input file and spare contents
-		std::ifstream inFile("Units/" + unit.name + ".txt");
-		std::string contents = "";
-
-		// For each line in the file
-		std::string line;
-		while (getline(inFile, line)) {
-			// if the string does not contain a `: `, save it for later
-			if (line.find(": ") == std::string::npos)
-				contents += line + "\n";
+// Queue each changed entity of a list to be written, returning the number queued
+// Entities loaded from a markdown file are counted in skipped instead, as their own file would load them a second time
+template <typename T>
+int queueChanged(const std::vector<T>& list, saveCache& saved, saveWriter& writer, int& skipped) {
+	int queued = 0;
+	support::outputSink out;
+
+	for (const T& ent : list) {
+		const std::string& source = ent.source.str();
+		if (source.size() >= 3 && source.compare(source.size() - 3, 3, ".md") == 0) {
+			skipped++;
+			continue;
 		}
-		inFile.close();
 
-		// Reopen the file as an output file
-		std::ofstream outFile("Units/" + unit.name + ".txt");
+		// Skip an entity whose file already holds its content
+		saveCache::serialize(out, ent);
+		std::string content = out.take();
+		std::string path = saveCache::path(ent);
 
-		// Write the content from the unit
-		outFile << "Rank: " << GroupList.ranks[unit.rank] << "\n";
-		outFile << "Member: " << unit.member << "\n";
-		for (std::string aspect : unit.aspects)
-			outFile << "Aspect: " << aspect << "\n";
+		if (saved.unchanged(path, content))
+			continue;
 
-		// Rewrite the spare contents
-		outFile << contents;
-		outFile.close();
+		// Note the content now, the writer reporting any file it fails to write
+		saved.note(path, content);
+		writer.submit(std::move(path), std::move(content));
+		queued++;
 	}
+
+	return queued;
+}
+
+void interactions::writeToFile(const std::vector<character>& characterList, const std::vector<unit>& unitList, saveWriter& writer) {
+	// Compare against the saved contents of the shared lists, writing every entity of any other lists
+	saveCache scratch;
+	saveCache& saved = CharacterList.holds(characterList) && GroupList.holds(unitList) ? RosterSaves : scratch;
+
+	// Serialize here, as the lists may change once the menu resumes, and leave the files to the writer
+	int skipped = 0;
+	int queued = queueChanged(characterList, saved, writer, skipped) + queueChanged(unitList, saved, writer, skipped);
+
+	std::cout << "Saving " << queued << (queued == 1 ? " changed entity.\n" : " changed entities.\n");
+	if (skipped > 0)
+		std::cout << "Skipped " << skipped << (skipped == 1 ? " entity" : " entities") << " loaded from markdown files, which are never written.\n";
+	std::cout << "\n";
 }
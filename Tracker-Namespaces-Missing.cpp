@@ -1,169 +1,401 @@
 #include "Tracker.h"
 
-void missingEntity::refacChar(const std::string& missingChar, std::vector<character>& characterList) {
+void missingEntity::refacChar(const symbol& missingChar, entityStore<character>& characterStore) {
 	// Prompt for selection
-	int selection = support::prompt("The character " + missingChar + " is missing", { "Rename", "Delete" });
+	int selection = support::prompt("The character " + missingChar.str() + " is missing", { "Rename", "Delete" });
 
 	// Refactor based on selection
 	switch (selection) {
 	case 1:
-		renameChar(missingChar, characterList);
+		// Drop any earlier deletions before listing the names
+		simpleFind::compact(characterStore);
+		renameChar(missingChar, characterStore.entities());
 		break;
 	case 2:
-		deleteChar(missingChar, characterList);
+		deleteChar(missingChar, characterStore);
 		break;
 	}
 
 	return;
 }
 
-void missingEntity::refacUnit(const std::string& missingUnit, std::vector<character>& characterList, std::vector<unit>& unitList) {
+void missingEntity::refacUnit(const symbol& missingUnit, entityStore<character>& characterStore, entityStore<unit>& unitStore) {
 	// Prompt for selection
-	int selection = support::prompt("The unit " + missingUnit + " is missing", { "Rename", "Delete", "Split" });
+	int selection = support::prompt("The unit " + missingUnit.str() + " is missing", { "Rename", "Delete", "Split" });
 
 	// Refactor based on selection
+	// Drop any earlier deletions before listing the names
+	if (selection != 2) {
+		simpleFind::compact(characterStore);
+		simpleFind::compact(unitStore);
+	}
+
 	switch (selection) {
 	case 1:
-		renameUnit(missingUnit, characterList, unitList);
+		renameUnit(missingUnit, characterStore.entities(), unitStore.entities());
 		break;
 	case 2:
-		deleteUnit(missingUnit, characterList, unitList);
+		deleteUnit(missingUnit, characterStore, unitStore);
 		break;
 	case 3:
-		splitUnit(missingUnit, characterList, unitList);
+		splitUnit(missingUnit, characterStore.entities(), unitStore.entities());
 		break;
 	}
 
 	return;
 }
 
-void missingEntity::renameChar(const std::string& missingChar, std::vector<character>& characterList) {
+void missingEntity::renameChar(const symbol& missingChar, std::vector<character>& characterList) {
 	// Declare name variables
 	std::vector<std::string> possibleNames;
 
 	// Append all character names to names
-	for (character chara : characterList) {
-		possibleNames.push_back(chara.name);
+	for (const character& chara : characterList) {
+		possibleNames.push_back(chara.name.str());
 	}
 
 	// Prompt for the true names
-	int nameLoc = support::prompt("What is the true name of " + missingChar, possibleNames) - 1;
+	int nameLoc = support::prompt("What is the true name of " + missingChar.str(), possibleNames) - 1;
+	symbol trueName = characterList[nameLoc].name;
 
 	// For every character's relation
 	for (character& chara : characterList) {
 		for (entity::tagFeature& relation : chara.relations) {
 			// If the missing char's name was found, change it for the true name
-			if (relation.name == missingChar)
-				relation.name = possibleNames[nameLoc];
+			if (relation.name == missingChar) {
+				relation.name = trueName;
+				interactions::markEdited(characterList, chara.name);
+			}
 		}
 	}
 }
 
-void missingEntity::renameUnit(const std::string& missingUnit, std::vector<character>& characterList, std::vector<unit>& unitList) {
+void missingEntity::renameUnit(const symbol& missingUnit, std::vector<character>& characterList, std::vector<unit>& unitList) {
 	// Declare name variables
 	std::vector<std::string> possibleNames;
 
 	// Append all unit names to names
-	for (unit unit : unitList) {
-		possibleNames.push_back(unit.name);
+	for (const unit& unit : unitList) {
+		possibleNames.push_back(unit.name.str());
 	}
 
 	// Prompt for the true names
-	int nameLoc = support::prompt("What is the true name of " + missingUnit, possibleNames) - 1;
+	int nameLoc = support::prompt("What is the true name of " + missingUnit.str(), possibleNames) - 1;
+	symbol trueName = unitList[nameLoc].name;
 
 	// For every character's member
-	for (character& chara : characterList) {
+	for (size_t i = 0; i < characterList.size(); i++) {
 		// If the missing unit's name was found, change it for the true name
-		if (chara.member == missingUnit)
-			chara.member = possibleNames[nameLoc];
+		if (characterList[i].member == missingUnit) {
+			characterList[i].member = trueName;
+			interactions::markMoved(characterList, i, missingUnit);
+		}
 	}
 
 	// For every unit
-	for (unit& uni : unitList) {
+	for (size_t i = 0; i < unitList.size(); i++) {
 		// If the missing unit's name is the member, change it for the true name
-		if (uni.member == missingUnit)
-			uni.member = possibleNames[nameLoc];
+		if (unitList[i].member == missingUnit) {
+			unitList[i].member = trueName;
+			interactions::markMoved(unitList, i, missingUnit);
+		}
 	}
 }
 
-void missingEntity::splitUnit(const std::string& missingUnit, std::vector<character>& characterList, std::vector<unit>& unitList) {
+void missingEntity::splitUnit(const symbol& missingUnit, std::vector<character>& characterList, std::vector<unit>& unitList) {
 	std::vector<int> freeChars;
 	std::vector<std::string> possibleNames;
 	std::vector<int> newNames;
 
 	// Append all unit names to names
-	for (unit unit : unitList) {
-		possibleNames.push_back(unit.name);
+	for (const unit& unit : unitList) {
+		possibleNames.push_back(unit.name.str());
 	}
 
 	// Note all characters the are part of the unit
-	for (character& chara : characterList) {
+	for (size_t i = 0; i < characterList.size(); i++) {
+		character& chara = characterList[i];
+
 		if (chara.member == missingUnit) {
 			// Prompt for a new unit
-			int select = support::prompt("What unit does " + chara.name + " now belong to?", possibleNames) - 1;
+			int select = support::prompt("What unit does " + chara.name.str() + " now belong to?", possibleNames) - 1;
 
 			// Change the character's unit
-			chara.member = possibleNames[select];
+			chara.member = unitList[select].name;
+			interactions::markMoved(characterList, i, missingUnit);
 		}
 	}
 
-	for (unit& curUnit : unitList) {
+	for (size_t i = 0; i < unitList.size(); i++) {
+		unit& curUnit = unitList[i];
+
 		if (curUnit.member == missingUnit) {
 			// Prompt for a new unit
-			int select = support::prompt("What unit does " + curUnit.name + " now belong to?", possibleNames) - 1;
+			int select = support::prompt("What unit does " + curUnit.name.str() + " now belong to?", possibleNames) - 1;
 
 			// Change the unit's unit
-			if (possibleNames[select] == curUnit.name) {
-				curUnit.member = "None";
+			if (unitList[select].name == curUnit.name) {
+				curUnit.member = symbol::none;
 			}
 			else {
-				curUnit.member = possibleNames[select];
+				curUnit.member = unitList[select].name;
 			}
+			interactions::markMoved(unitList, i, missingUnit);
 		}
 	}
 
 }
 
-void missingEntity::deleteChar(const std::string& missingChar, std::vector<character>& characterList) {
-	// If element is found found, erase it 
-	for (int i = characterList.size() - 1; i >= 0; i--) {
-		if (characterList[i].name == missingChar) {
-			characterList.erase(characterList.begin() + i);
-			break;
-		}
-	}
+void missingEntity::deleteChar(const symbol& missingChar, entityStore<character>& characterStore) {
+	std::vector<character>& characterList = characterStore.entities();
 
-	// Remove the unit from the characterList
+	// If element is found, remove it 
+	characterStore.remove(characterStore.find(missingChar));
+	interactions::markEdited(characterList, missingChar);
+
+	// Remove the character from the remaining relations
 	for (int i = characterList.size() - 1; i >= 0; i--) {
+		if (characterStore.removed(i))
+			continue;
+
 		for (int j = characterList[i].relations.size() - 1; j >= 0; j--) {
-			if (characterList[i].relations[j].name == missingChar)
+			if (characterList[i].relations[j].name == missingChar) {
 				characterList[i].relations.erase(characterList[i].relations.begin() + j);
+				interactions::markEdited(characterList, characterList[i].name);
+			}
 		}
 	}
 
 	return;
 }
 
-void missingEntity::deleteUnit(const std::string& missingUnit, std::vector<character>& characterList, std::vector<unit>& unitList) {
-	// If element is found found, erase it 
-	for (int i = unitList.size() - 1; i >= 0; i--) {
-		if (unitList[i].name == missingUnit) {
-			unitList.erase(unitList.begin() + i);
-			break;
-		}
-	}
+void missingEntity::deleteUnit(const symbol& missingUnit, entityStore<character>& characterStore, entityStore<unit>& unitStore) {
+	std::vector<character>& characterList = characterStore.entities();
+	std::vector<unit>& unitList = unitStore.entities();
+
+	// If element is found, remove it 
+	unitStore.remove(unitStore.find(missingUnit));
+	interactions::markEdited(unitList, missingUnit);
 
 	// Remove the unit from the characterList
 	for (int i = characterList.size() - 1; i >= 0; i--) {
-		if (characterList[i].member == missingUnit)
-			characterList[i].member = "None";
+		if (!characterStore.removed(i) && characterList[i].member == missingUnit) {
+			characterList[i].member = symbol::none;
+			interactions::markMoved(characterList, i, missingUnit);
+		}
 	}
 
-	// Remove the unit from the unitList
+	// Remove the unit from the remaining units
 	for (int i = unitList.size() - 1; i >= 0; i--) {
-		if (unitList[i].member == missingUnit)
-			unitList[i].member = "None";
+		if (!unitStore.removed(i) && unitList[i].member == missingUnit) {
+			unitList[i].member = symbol::none;
+			interactions::markMoved(unitList, i, missingUnit);
+		}
 	}
 
 	return;
-}
\ No newline at end of file
+}
+
+void missingEntity::refacBatch(const std::string& file, entityStore<character>& characterStore, entityStore<unit>& unitStore) {
+	// Drop any earlier deletions, so every position below is live
+	simpleFind::compact(characterStore);
+	simpleFind::compact(unitStore);
+
+	std::vector<character>& characterList = characterStore.entities();
+	std::vector<unit>& unitList = unitStore.entities();
+
+	// A single line of the document
+	struct refacRule {
+		enum ruleType { renameChar, deleteChar, renameUnit, deleteUnit, splitUnit } type;
+		symbol name;
+		symbol member;
+		symbol target;
+		int changes;
+	};
+
+	std::ifstream inputFile(file);
+	if (!inputFile) {
+		std::cout << "'" << file << "' cannot be found.\n\n";
+		return;
+	}
+
+	// Read the rules, noting which rule applies to each name
+	std::vector<refacRule> rules;
+	std::unordered_map<symbol, int> charRules, unitRules;
+	std::unordered_map<symbol, std::unordered_map<symbol, int>> splitRules;
+
+	support::delimSplitter delims({ ": " });
+	std::vector<std::string_view> parts;
+	std::string line;
+
+	while (getline(inputFile, line)) {
+		if (!line.empty() && line.back() == '\r')
+			line.pop_back();
+
+		delims.split(line, parts);
+
+		refacRule rule = { refacRule::renameChar, symbol::none, symbol::none, symbol::none, 0 };
+		bool valid = false;
+
+		if (parts.size() == 3 && parts[0] == "Rename Character") {
+			rule = { refacRule::renameChar, symbol(parts[1]), symbol::none, symbol(parts[2]), 0 };
+			valid = simpleFind::find(characterList, rule.target) != -1;
+		}
+		else if (parts.size() == 2 && parts[0] == "Delete Character") {
+			rule = { refacRule::deleteChar, symbol(parts[1]), symbol::none, symbol::none, 0 };
+			valid = true;
+		}
+		else if (parts.size() == 3 && parts[0] == "Rename Unit") {
+			rule = { refacRule::renameUnit, symbol(parts[1]), symbol::none, symbol(parts[2]), 0 };
+			valid = simpleFind::find(unitList, rule.target) != -1;
+		}
+		else if (parts.size() == 2 && parts[0] == "Delete Unit") {
+			rule = { refacRule::deleteUnit, symbol(parts[1]), symbol::none, symbol::none, 0 };
+			valid = true;
+		}
+		else if (parts.size() == 4 && parts[0] == "Split Unit") {
+			rule = { refacRule::splitUnit, symbol(parts[1]), symbol(parts[2]), symbol(parts[3]), 0 };
+			valid = simpleFind::find(unitList, rule.target) != -1;
+		}
+		else if (line.empty())
+			continue;
+
+		// Skip a line that can't be applied
+		if (!valid) {
+			std::cout << "Skipped '" << line << "'\n";
+			continue;
+		}
+
+		rules.push_back(rule);
+		int index = rules.size() - 1;
+
+		if (rule.type == refacRule::renameChar || rule.type == refacRule::deleteChar)
+			charRules[rule.name] = index;
+		else if (rule.type == refacRule::splitUnit)
+			splitRules[rule.name][rule.member] = index;
+		else
+			unitRules[rule.name] = index;
+	}
+
+	// Return the new membership of an entity, counting the change against its rule
+	auto remapMember = [&](const symbol& name, const symbol& member) -> symbol {
+		auto split = splitRules.find(member);
+		if (split != splitRules.end()) {
+			auto found = split->second.find(name);
+			if (found != split->second.end()) {
+				refacRule& rule = rules[found->second];
+				rule.changes++;
+
+				// A unit moved into itself belongs to no unit
+				return rule.target == name ? symbol::none : rule.target;
+			}
+		}
+
+		auto found = unitRules.find(member);
+		if (found == unitRules.end())
+			return member;
+
+		refacRule& rule = rules[found->second];
+		rule.changes++;
+		return rule.type == refacRule::deleteUnit ? symbol::none : rule.target;
+	};
+
+	// Apply every rule in one pass over the characters
+	std::vector<entityStore<character>::handle> eraseChars;
+
+	for (size_t i = 0; i < characterList.size(); i++) {
+		character& chara = characterList[i];
+
+		// Remap the membership
+		symbol previous = chara.member;
+		chara.member = remapMember(chara.name, previous);
+		if (chara.member != previous)
+			interactions::markMoved(characterList, i, previous);
+
+		// Rename or remove each affected relation
+		size_t kept = 0;
+		bool edited = false;
+
+		for (size_t j = 0; j < chara.relations.size(); j++) {
+			auto found = charRules.find(chara.relations[j].name);
+
+			if (found != charRules.end()) {
+				refacRule& rule = rules[found->second];
+				rule.changes++;
+				edited = true;
+
+				if (rule.type == refacRule::deleteChar)
+					continue;
+
+				chara.relations[j].name = rule.target;
+			}
+
+			if (kept != j)
+				chara.relations[kept] = std::move(chara.relations[j]);
+			kept++;
+		}
+
+		chara.relations.resize(kept);
+		if (edited)
+			interactions::markEdited(characterList, chara.name);
+
+		// Note a deleted character
+		auto found = charRules.find(chara.name);
+		if (found != charRules.end() && rules[found->second].type == refacRule::deleteChar) {
+			interactions::markEdited(characterList, chara.name);
+			eraseChars.push_back(characterStore.at(i));
+		}
+	}
+
+	// Then over the units
+	std::vector<entityStore<unit>::handle> eraseUnits;
+
+	for (size_t i = 0; i < unitList.size(); i++) {
+		unit& uni = unitList[i];
+
+		symbol previous = uni.member;
+		uni.member = remapMember(uni.name, previous);
+		if (uni.member != previous)
+			interactions::markMoved(unitList, i, previous);
+
+		auto found = unitRules.find(uni.name);
+		if (found != unitRules.end() && rules[found->second].type == refacRule::deleteUnit) {
+			interactions::markEdited(unitList, uni.name);
+			eraseUnits.push_back(unitStore.at(i));
+		}
+	}
+
+	// Remove the deleted entities, compacting each list once
+	for (const entityStore<character>::handle& chara : eraseChars)
+		characterStore.remove(chara);
+	for (const entityStore<unit>::handle& uni : eraseUnits)
+		unitStore.remove(uni);
+
+	simpleFind::compact(characterStore);
+	simpleFind::compact(unitStore);
+
+	// Report what changed
+	for (const refacRule& rule : rules) {
+		switch (rule.type) {
+		case refacRule::renameChar:
+			std::cout << "Renamed the character " << rule.name << " to " << rule.target;
+			break;
+		case refacRule::deleteChar:
+			std::cout << "Deleted the character " << rule.name;
+			break;
+		case refacRule::renameUnit:
+			std::cout << "Renamed the unit " << rule.name << " to " << rule.target;
+			break;
+		case refacRule::deleteUnit:
+			std::cout << "Deleted the unit " << rule.name;
+			break;
+		case refacRule::splitUnit:
+			std::cout << "Moved " << rule.member << " from the unit " << rule.name << " to " << rule.target;
+			break;
+		}
+
+		std::cout << ", changing " << rule.changes << (rule.changes == 1 ? " reference\n" : " references\n");
+	}
+
+	std::cout << "\n";
+}
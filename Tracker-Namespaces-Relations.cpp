@@ -6,61 +6,33 @@
 */
 
 void modifyRelations::addMissingRelations(std::vector<character>& characterList, std::vector<unit>& unitList) {
-	// Variables
-	unsigned int entitySize = characterList.size() + unitList.size();
-	std::vector<std::vector<bool>> relationMatrix;
-	std::vector<std::string> names;
-
-	// Append all character names to names
-	for (character chara : characterList) {
-		names.push_back(chara.name);
-	}
-
-	// Append all unit names to names
-	for (unit unit : unitList) {
-		names.push_back(unit.name);
-	}
-
-	// Fill the relation matrix with false, representing no bond
-	for (int i = 0; i < entitySize; i++)
-		relationMatrix.push_back(std::vector<bool>(entitySize, false));
-
-	// For each character's relation
-	for (int i = 0; i < characterList.size(); i++) {
-		for (entity::tagFeature relation : characterList[i].relations) {
-			// Find the relation's name in `names`
-			auto relPos = find(names.begin(), names.end(), relation.name);
-			int intPos = std::distance(names.begin(), relPos);
-
-			// If the relation exists
-			if (relPos != names.end()) {
-				// Modify the relation matrix
-				relationMatrix[i][intPos] = true;
-				relationMatrix[intPos][i] = true;
-			}
-		}
-	}
+	// Build the graph of existing relations
+	relationGraph graph(characterList, unitList);
 
 	// For each character
 	for (int i = 0; i < characterList.size(); i++) {
-		// Record the character's relation names
-		std::vector<std::string> relateNames;
-		for (entity::tagFeature relation : characterList[i].relations) {
-			relateNames.push_back(relation.name);
-		}
-
-		// For every entity
-		for (int j = 0; j < entitySize; j++) {
-			// if a relation doesn't exist, continue
-			if (!relationMatrix[i][j])
+		character& chara = characterList[i];
+		size_t existing = chara.relations.size();
+		int previous = -1;
+
+		// For every entity relating to the character
+		for (int source : graph.relatedBy(i)) {
+			// Skip a repeated relation from the same entity
+			if (source == previous)
 				continue;
+			previous = source;
+
+			// If the relation isn't already present, add it
+			auto last = chara.relations.begin() + existing;
+			auto found = std::find_if(chara.relations.begin(), last,
+				[&](const entity::tagFeature& relation) { return relation.name == graph.name(source); });
 
-			// if the relation isn't already present, add it
-			if (find(relateNames.begin(), relateNames.end(), names[j]) == relateNames.end()) {
+			if (found == last) {
 				entity::tagFeature newRel;
-				newRel.name = names[j];
+				newRel.name = graph.name(source);
 				newRel.desc = "New Relation";
-				characterList[i].relations.push_back(newRel);
+				chara.relations.push_back(newRel);
+				interactions::markEdited(characterList, chara.name);
 			}
 		}
 	}
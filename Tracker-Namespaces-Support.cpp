@@ -5,28 +5,187 @@
 *
 */
 
-int simpleFind::find(const std::vector<character>& arr, const std::string& val) {
-	// Initialize Variables
-	std::vector<std::string> names;
+// Return the shared store holding a list, nullptr for any other list
+entityStore<character>* sharedStore(const std::vector<character>& arr) {
+	return CharacterList.holds(arr) ? &CharacterList : nullptr;
+}
+
+entityStore<unit>* sharedStore(const std::vector<unit>& arr) {
+	return GroupList.holds(arr) ? &GroupList : nullptr;
+}
+
+template <typename T>
+int simpleFind::find(const std::vector<T>& arr, const symbol& val) {
+	const entityStore<T>* store = sharedStore(arr);
+
+	// Trust the store's index for every entity it tracks
+	if (store != nullptr) {
+		int pos = store->index.find(val);
 
-	// Convert to strings
-	for (character chara : arr)
-		names.push_back(chara.name);
+		// Accept a hit that still holds the name
+		if (pos != -1 && size_t(pos) < arr.size() && arr[pos].name == val && !store->removed(pos))
+			return pos;
 
-	// Return Array Simple Find
-	return find(names, val);
+		// Accept a miss while every entity is tracked
+		if (pos == -1 && store->tracked())
+			return -1;
+	}
+
+	// Otherwise compare each live entity's name id
+	for (size_t i = 0; i < arr.size(); i++)
+		if (arr[i].name == val && (store == nullptr || !store->removed(i)))
+			return i;
+
+	// Otherwise return -1
+	return -1;
 }
 
-int simpleFind::find(const std::vector<unit>& arr, const std::string& val) {
-	// Initialize Variables
-	std::vector<std::string> names;
+template <typename T>
+void simpleFind::reindex(const std::vector<T>& arr) {
+	entityStore<T>* store = sharedStore(arr);
+	if (store != nullptr)
+		reindex(*store);
+}
 
-	// Convert to strings
-	for (unit uni : arr)
-		names.push_back(uni.name);
+template <typename T>
+void simpleFind::reindex(entityStore<T>& store) {
+	store.reindex();
+
+	// Drop the indexes built over the shared lists
+	if (sharedStore(store.entities()) == nullptr)
+		return;
+
+	RosterHierarchy.invalidate();
+	RosterSizes.invalidate();
+	RosterRanks.invalidate();
+	if constexpr (std::is_same_v<T, unit>)
+		RosterAncestors.invalidate();
+	else
+		RosterTags.invalidate();
+}
+
+template <typename T>
+void simpleFind::compact(entityStore<T>& store) {
+	if (store.tombstones() > 0)
+		reindex(store);
+}
+
+template int simpleFind::find(const std::vector<character>& arr, const symbol& val);
+template int simpleFind::find(const std::vector<unit>& arr, const symbol& val);
+template void simpleFind::reindex(const std::vector<character>& arr);
+template void simpleFind::reindex(const std::vector<unit>& arr);
+template void simpleFind::reindex(entityStore<character>& store);
+template void simpleFind::reindex(entityStore<unit>& store);
+template void simpleFind::compact(entityStore<character>& store);
+template void simpleFind::compact(entityStore<unit>& store);
+
+const unitHierarchy& simpleFind::hierarchy(const std::vector<character>& arr, unitHierarchy& scratch) {
+	// Keep the shared hierarchy until the shared list changes size
+	if (CharacterList.holds(arr)) {
+		if (!RosterHierarchy.current(arr.size()))
+			RosterHierarchy.build(arr);
+
+		return RosterHierarchy;
+	}
 
-	// Return Array Simple Find
-	return find(names, val);
+	scratch.build(arr);
+	return scratch;
+}
+
+const unitAncestors& simpleFind::ancestors(const std::vector<unit>& arr, unitAncestors& scratch) {
+	// Keep the shared ancestors until the shared list changes
+	if (GroupList.holds(arr)) {
+		if (!RosterAncestors.current(arr.size()))
+			RosterAncestors.build(arr);
+
+		return RosterAncestors;
+	}
+
+	scratch.build(arr);
+	return scratch;
+}
+
+const unitSizes& simpleFind::sizes(const std::vector<character>& charArr, const std::vector<unit>& unitArr, unitSizes& scratch) {
+	// Keep the shared sizes until the shared lists change, moving characters in place
+	if (CharacterList.holds(charArr) && GroupList.holds(unitArr)) {
+		if (!RosterSizes.current(charArr.size(), unitArr.size())) {
+			unitAncestors unused;
+			RosterSizes.build(charArr, simpleFind::ancestors(unitArr, unused));
+		}
+
+		return RosterSizes;
+	}
+
+	unitAncestors tree;
+	tree.build(unitArr);
+	scratch.build(charArr, tree);
+	return scratch;
+}
+
+const tagIndex& simpleFind::tags(const std::vector<character>& arr, tagIndex& scratch) {
+	// Keep the shared tags until the shared list changes, refiling edited characters in place
+	if (CharacterList.holds(arr)) {
+		if (!RosterTags.current(arr.size()))
+			RosterTags.build(arr);
+
+		return RosterTags;
+	}
+
+	scratch.build(arr);
+	return scratch;
+}
+
+const rankIndex& simpleFind::ranks(const std::vector<character>& charArr, const std::vector<unit>& unitArr, rankIndex& scratch) {
+	// Keep the shared buckets until the shared lists change, refiling edited entities in place
+	if (CharacterList.holds(charArr) && GroupList.holds(unitArr)) {
+		if (!RosterRanks.current(charArr.size(), unitArr.size()))
+			RosterRanks.build(charArr, unitArr);
+
+		return RosterRanks;
+	}
+
+	scratch.build(charArr, unitArr);
+	return scratch;
+}
+
+/*
+* Name Index Functions
+*
+*/
+
+void nameIndex::clear() {
+	positions.clear();
+	indexed = 0;
+}
+
+void nameIndex::add(const symbol& name, int position) {
+	// Keep the first position, matching a front to back search
+	positions.try_emplace(name, slot{ position, 0 }).first->second.count++;
+	indexed++;
+}
+
+void nameIndex::remove(const symbol& name, int position, int next) {
+	auto it = positions.find(name);
+	if (it == positions.end())
+		return;
+
+	// Forget the name with its last entity, otherwise move on from a removed first position
+	if (--it->second.count == 0)
+		positions.erase(it);
+	else if (it->second.position == position)
+		it->second.position = next;
+
+	indexed--;
+}
+
+int nameIndex::find(const symbol& name) const {
+	auto it = positions.find(name);
+	return it == positions.end() ? -1 : it->second.position;
+}
+
+int nameIndex::occurrences(const symbol& name) const {
+	auto it = positions.find(name);
+	return it == positions.end() ? 0 : it->second.count;
 }
 
 /*
@@ -132,79 +291,54 @@ std::vector<std::string> rules::genRules(const std::vector<std::string>& crewNam
 }
 
 void rules::filterRules(const std::vector<std::string>& rulesList, std::vector<character>& characterList, std::vector<unit>& unitList) {
-	// Declare variable for holding entity information
-	std::vector<std::vector<std::string>> possibleEntities = {};
-	std::vector<std::string> possibleNames = {};
-
-	// Pull all neccessary entity information
-	for (character ent : characterList) {
-		possibleNames.push_back(ent.name);
-		possibleEntities.push_back({ ent.name, CharacterList.ranks[ent.rank], ent.member, "Character" });
-	}
-
-	for (unit ent : unitList) {
-		possibleNames.push_back(ent.name);
-		possibleEntities.push_back({ ent.name, GroupList.ranks[ent.rank], ent.member, "Unit" });
+	// Rule split into its type and value once, ahead of the entity scans
+	struct parsedRule {
+		std::string type;
+		std::string value;
+		symbol member;
+	};
+
+	std::vector<parsedRule> parsedRules;
+	for (const std::string& rule : rulesList) {
+		parsedRule parsed = { rule.substr(0, rule.find(":")), rule.substr(rule.find(":") + 1), symbol::none };
+		if (parsed.type == "Member")
+			parsed.member = symbol(parsed.value);
+
+		parsedRules.push_back(std::move(parsed));
 	}
 
-	// For each of the rules
-	for (std::string rule : rulesList) {
-		// Declare variable to note the filtered entities
-		std::vector<bool> filtEnti = {};
-
-		// For every possible entity
-		for (std::vector<std::string> ent : possibleEntities) {
-			std::string ruleType = rule.substr(0, rule.find(":"));
-			// 'Only' Rules
-			if (ruleType == "Only") {
-				// Verify the unit type
-				if (rule.substr(rule.find(":") + 1) == ent[3])
-					filtEnti.push_back(false);
-				else
-					filtEnti.push_back(true);
-			}
-
-			// 'Ranking' Rules
-			if (ruleType == "Ranking") {
-				// Verify the ranking
-				if (rule.substr(rule.find(":") + 1) == ent[1])
-					filtEnti.push_back(false);
-				else
-					filtEnti.push_back(true);
-			}
-
-			// 'Member' Rules
-			if (ruleType == "Member") {
-				// Verify the membership
-				if (rule.substr(rule.find(":") + 1) == ent[2])
-					filtEnti.push_back(false);
-				// Treat unit as a member of themselves
-				else if (rule.substr(rule.find(":") + 1) == ent[0])
-					filtEnti.push_back(false);
-				else
-					filtEnti.push_back(true);
-			}
+	// Determine whether an entity follows every rule
+	auto follows = [&](const entity& ent, const std::string& type, const std::vector<std::string>& ranks) {
+		for (const parsedRule& rule : parsedRules) {
+			// 'Only' Rules: verify the unit type
+			if (rule.type == "Only" && rule.value != type)
+				return false;
+			// 'Ranking' Rules: verify the ranking
+			if (rule.type == "Ranking" && rule.value != ranks[ent.rank])
+				return false;
+			// 'Member' Rules: verify the membership, treating units as members of themselves
+			if (rule.type == "Member" && rule.member != ent.member && rule.member != ent.name)
+				return false;
 		}
 
-		// Filter out entities that don't follow the current rule
-		for (int i = filtEnti.size() - 1; i >= 0; i--) {
-			if (filtEnti[i]) {
-				possibleNames.erase(possibleNames.begin() + i);
-				possibleEntities.erase(possibleEntities.begin() + i);
-			}
-		}
+		return true;
+	};
 
-	}
+	// Note the names of every entity following the rules
+	std::unordered_set<symbol> possibleNames;
+	for (const character& chara : characterList)
+		if (follows(chara, "Character", CharacterList.ranks))
+			possibleNames.insert(chara.name);
 
-	for (int i = characterList.size() - 1; i >= 0; i--) {
-		// If the character's name can't be found in possibleNames, remove it from the Vector
-		if (find(possibleNames.begin(), possibleNames.end(), characterList[i].name) == possibleNames.end())
-			characterList.erase(characterList.begin() + i);
-	}
+	for (const unit& uni : unitList)
+		if (follows(uni, "Unit", GroupList.ranks))
+			possibleNames.insert(uni.name);
 
-	for (int i = unitList.size() - 1; i >= 0; i--) {
-		// If the unit's name can't be found in possibleNames, remove it from the Vector
-		if (find(possibleNames.begin(), possibleNames.end(), unitList[i].name) == possibleNames.end())
-			unitList.erase(unitList.begin() + i);
-	}
-}
\ No newline at end of file
+	// If the character's name can't be found in possibleNames, remove it from the Vector
+	characterList.erase(std::remove_if(characterList.begin(), characterList.end(),
+		[&](const character& chara) { return possibleNames.count(chara.name) == 0; }), characterList.end());
+
+	// If the unit's name can't be found in possibleNames, remove it from the Vector
+	unitList.erase(std::remove_if(unitList.begin(), unitList.end(),
+		[&](const unit& uni) { return possibleNames.count(uni.name) == 0; }), unitList.end());
+}
@@ -0,0 +1,258 @@
+#include "Tracker.h"
+#include <filesystem>
+#include <limits>
+#include <map>
+#include <tuple>
+
+#ifdef __linux__
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+/*
+* Watch Namespace Functions
+*
+*/
+
+// Names of the entities loaded from each watched file
+typedef std::map<std::string, std::vector<symbol>> fileNameMap;
+
+// Return the position of the live entity a file loaded under a name, -1 if there is none
+// A name repeated across files only matches the entity loaded from this file
+template <typename T>
+int findFromFile(const entityStore<T>& store, const symbol& name, const symbol& source) {
+	const std::vector<T>& list = store.entities();
+	int pos = store.index.find(name);
+
+	if (pos == -1 || list[pos].source == source)
+		return pos;
+
+	// Search the name's other entities only when it repeats
+	if (store.index.occurrences(name) > 1) {
+		for (size_t i = pos + 1; i < list.size(); i++)
+			if (list[i].name == name && list[i].source == source && !store.removed(i))
+				return i;
+	}
+
+	return -1;
+}
+
+// Load a single file into a fresh list, then swap its entities into the store
+// A file that can't be read leaves the store alone and returns false; removed entities stay as tombstones until watching stops
+template <typename T>
+bool reloadEntities(const std::string& dir, const std::string& file, entityStore<T>& store, std::vector<rosterString>& history, std::vector<symbol>& fileNames,
+	void (*loadFile)(std::string, std::vector<T>&, std::vector<rosterString>&)) {
+	std::vector<T>& list = store.entities();
+	symbol source(file);
+
+	// Variables for the freshly loaded entities
+	std::vector<T> loaded;
+	std::vector<rosterString> loadedHistory;
+	std::vector<symbol> loadedNames;
+
+	// Parse the file if it still exists, a deleted file loads nothing
+	try {
+		if (std::filesystem::is_regular_file(dir + "/" + file)) {
+			// The loaders read an unopenable file as empty, so check it can be read first
+			if (!std::ifstream(dir + "/" + file))
+				return false;
+
+			loadFile(file, loaded, loadedHistory);
+		}
+	}
+	catch (...) {
+		return false;
+	}
+
+	for (const T& ent : loaded)
+		loadedNames.push_back(ent.name);
+
+	// Remove entities the file no longer contains
+	for (const symbol& name : fileNames) {
+		if (find(loadedNames.begin(), loadedNames.end(), name) != loadedNames.end())
+			continue;
+
+		int index = findFromFile(store, name, source);
+		if (index == -1)
+			continue;
+
+		// Release the removed character's history
+		if constexpr (std::is_same_v<T, character>) {
+			if (list[index].historyIndex != -1)
+				history[list[index].historyIndex].clear();
+		}
+
+		interactions::markRemoved(list, index);
+		store.remove(store.at(index));
+	}
+
+	// Swap in each loaded entity, keeping an existing entity's place in the list
+	for (T& ent : loaded) {
+		int index = findFromFile(store, ent.name, source);
+
+		if constexpr (std::is_same_v<T, character>) {
+			// Reuse the previous history slot where there is one
+			int slot = index == -1 ? -1 : list[index].historyIndex;
+
+			if (ent.historyIndex == -1) {
+				if (slot != -1)
+					history[slot].clear();
+			}
+			else if (slot == -1) {
+				history.push_back(std::move(loadedHistory[ent.historyIndex]));
+				ent.historyIndex = history.size() - 1;
+			}
+			else {
+				history[slot] = std::move(loadedHistory[ent.historyIndex]);
+				ent.historyIndex = slot;
+			}
+		}
+
+		if (index == -1) {
+			store.add(std::move(ent));
+			interactions::markAdded(list, list.size() - 1);
+		}
+		else {
+			symbol previous = list[index].member;
+			list[index] = std::move(ent);
+			interactions::markMoved(list, index, previous);
+		}
+	}
+
+	// Remember the file's entities for its next change
+	fileNames = loadedNames;
+
+	return true;
+}
+
+// Note which entities each file holds, from the file each entity was loaded from
+template <typename T>
+void mapFileNames(const entityStore<T>& store, fileNameMap& fileNames) {
+	const std::vector<T>& list = store.entities();
+
+	for (size_t i = 0; i < list.size(); i++)
+		if (!store.removed(i) && list[i].source != symbol::none)
+			fileNames[list[i].source.str()].push_back(list[i].name);
+}
+
+// Identity of a problem, to tell the problems a reload introduced from those already known
+typedef std::tuple<int, uint32_t, bool, uint32_t> problemKey;
+
+problemKey keyOf(const diagnostic& diag) {
+	return { diag.problem, diag.entity.id(), diag.unitEntity, diag.value.id() };
+}
+
+// Reload the changed files, then report the problems they introduced
+void reloadFiles(const std::set<std::string>& charFiles, const std::set<std::string>& unitFiles, fileNameMap& charNames, fileNameMap& unitNames,
+	characterList& chars, groupList& groups) {
+	unsigned int threadCount = std::max(1u, std::thread::hardware_concurrency());
+
+	// Note the problems known before the reload
+	std::set<problemKey> known;
+	for (const diagnostic& diag : RosterValidation.check(chars, groups, threadCount))
+		known.insert(keyOf(diag));
+
+	// Reload each changed file with plain reads, as a mapped file truncated mid-write would fault
+	for (const std::string& file : charFiles) {
+		if (reloadEntities<character>("Characters", file, chars, chars.other, charNames[file], input::loadCharRead))
+			std::cout << "Reloaded Characters/" << file << "\n";
+		else
+			std::cout << "Unable to reload Characters/" << file << "\n";
+	}
+
+	for (const std::string& file : unitFiles) {
+		if (reloadEntities<unit>("Units", file, groups, chars.other, unitNames[file], input::loadUnitRead))
+			std::cout << "Reloaded Units/" << file << "\n";
+		else
+			std::cout << "Unable to reload Units/" << file << "\n";
+	}
+
+	// Recheck the edited names and every name referencing them, reporting only new problems
+	std::vector<diagnostic> introduced;
+	for (const diagnostic& diag : RosterValidation.check(chars, groups, threadCount))
+		if (known.count(keyOf(diag)) == 0)
+			introduced.push_back(diag);
+
+	interactions::printProblems(introduced);
+}
+
+void watch::watchFiles(characterList& chars, groupList& groups) {
+#ifdef __linux__
+	// Watch both entity directories for finished writes, renames and deletions
+	int notify = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+	if (notify == -1) {
+		std::cout << "Unable to watch for file changes.\n\n";
+		return;
+	}
+
+	uint32_t mask = IN_CLOSE_WRITE | IN_MOVED_FROM | IN_MOVED_TO | IN_DELETE;
+	int charWatch = inotify_add_watch(notify, "Characters", mask);
+	int unitWatch = inotify_add_watch(notify, "Units", mask);
+
+	if (charWatch == -1 || unitWatch == -1) {
+		std::cout << "Unable to watch the " << (charWatch == -1 ? "'Characters'" : "'Units'") << " directory.\n\n";
+		close(notify);
+		return;
+	}
+
+	// Note each file's entities before anything changes
+	fileNameMap charNames, unitNames;
+	mapFileNames(chars, charNames);
+	mapFileNames(groups, unitNames);
+
+	std::cout << "Watching for file changes, press Enter to stop.\n";
+
+	// Drop the rest of the menu's input line, so only a fresh line stops watching
+	std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+
+	// Wait on both the watch and the user
+	pollfd polls[2] = { { notify, POLLIN, 0 }, { STDIN_FILENO, POLLIN, 0 } };
+	alignas(inotify_event) char buffer[16384];
+
+	while (true) {
+		if (poll(polls, 2, -1) == -1)
+			break;
+
+		// Stop once the user enters a line, reading all of it so none reaches the next prompt
+		if (polls[1].revents & (POLLIN | POLLHUP)) {
+			std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+			break;
+		}
+
+		if (!(polls[0].revents & POLLIN))
+			continue;
+
+		// Gather every pending event, reloading each changed file once
+		std::set<std::string> charFiles, unitFiles;
+		ssize_t length;
+
+		while ((length = read(notify, buffer, sizeof(buffer))) > 0) {
+			for (char* pos = buffer; pos < buffer + length; ) {
+				inotify_event* event = reinterpret_cast<inotify_event*>(pos);
+				pos += sizeof(inotify_event) + event->len;
+
+				if (event->len == 0)
+					continue;
+
+				if (event->wd == charWatch)
+					charFiles.insert(event->name);
+				else if (event->wd == unitWatch)
+					unitFiles.insert(event->name);
+			}
+		}
+
+		reloadFiles(charFiles, unitFiles, charNames, unitNames, chars, groups);
+	}
+
+	close(notify);
+
+	// Drop the entities removed while watching, once rather than after every change
+	simpleFind::compact(chars);
+	simpleFind::compact(groups);
+
+	std::cout << "\n";
+#else
+	std::cout << "Watching for file changes is only available on Linux.\n\n";
+#endif
+}
@@ -5,12 +5,65 @@
 #include <fstream>
 #include <algorithm>
 #include <set>
+#include <thread>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <condition_variable>
+#include <unordered_set>
+#include <unordered_map>
 #include "General.h"
 
+// Interned Name, stored once in a roster-wide table and compared by id
+class symbol {
+public:
+	// Default to the "None" sentinel
+	constexpr symbol() = default;
+	// Intern a text, throwing std::length_error once the table is full
+	explicit symbol(std::string_view text);
+	explicit symbol(const std::string& text) : symbol(std::string_view(text)) {}
+	explicit symbol(const char* text) : symbol(std::string_view(text)) {}
+
+	// Return the symbol's text
+	const std::string& str() const;
+	// Return the symbol's id
+	uint32_t id() const { return index; }
+
+	friend bool operator==(const symbol& a, const symbol& b) { return a.index == b.index; }
+	friend bool operator!=(const symbol& a, const symbol& b) { return a.index != b.index; }
+
+	// The "None" sentinel
+	static const symbol none;
+
+private:
+	uint32_t index = 0;
+};
+
+// Write a symbol's text
+std::ostream& operator<<(std::ostream& out, const symbol& sym);
+support::outputSink& operator<<(support::outputSink& out, const symbol& sym);
+
+// Hash a symbol by id
+namespace std {
+	template <>
+	struct hash<symbol> {
+		size_t operator()(const symbol& sym) const { return sym.id(); }
+	};
+}
+
+// Roster text, allocated from the roster arena as it is parsed
+typedef std::pmr::string rosterString;
+
 // Feature Struct
 struct feature {
-	std::string name;
-	std::string desc;
+	symbol name;
+	rosterString desc;
+
+	feature() = default;
+	// Allocate the feature's text from an arena
+	explicit feature(std::pmr::memory_resource* arena) : desc(arena) {}
 
 	// Return the feature as a string
 	std::string returnFeat();
@@ -20,36 +73,51 @@ struct feature {
 class entity {
 public:
 	struct tagFeature : public feature {
-		std::vector<std::string> tags;
+		std::pmr::vector<rosterString> tags;
+
+		tagFeature() = default;
+		// Allocate the tagged feature's text and tags from an arena
+		explicit tagFeature(std::pmr::memory_resource* arena) : feature(arena), tags(arena) {}
 
 		// Return the tagged feature as a string
 		std::string returnFeat();
+		// Write the tagged feature into a sink
+		void output(support::outputSink& out) const;
 	};
 
-	std::string name = "None";
-	std::string member = "None";
+	symbol name;
+	symbol member;
+	symbol source;		// File the entity was loaded from, none if it was never loaded
 
 	int rank = 0;
 	//int historyIndex = -1;
 
-	std::vector<std::string> aspects = {};
+	std::pmr::vector<rosterString> aspects;
 	//std::vector<tagFeature> relations;
 
+	entity() = default;
+	// Allocate the entity's text from an arena
+	explicit entity(std::pmr::memory_resource* arena) : aspects(arena) {}
+
+	// Return the arena the entity's text is allocated from
+	std::pmr::memory_resource* arena() const { return aspects.get_allocator().resource(); }
+
 	// Add a feature based on an input string
-	void addFeature(const std::string& featString);
+	void addFeature(std::string_view featString);
 };
 
 // Unit Information
 class unit : public entity {
 public:
-	// Initializer
+	// Initializers
 	unit() = default;
+	explicit unit(std::pmr::memory_resource* arena) : entity(arena) {}
 
 	// Add a feature based on an input string
-	void addFeature(const std::string& featString);
+	void addFeature(std::string_view featString);
 
-	// Output the unit
-	std::string output() const;
+	// Write the unit into a sink
+	void output(support::outputSink& out) const;
 };
 
 // Character Information
@@ -59,76 +127,640 @@ public:
 	std::vector<tagFeature> relations;
 	int historyIndex = -1;
 
-	// Initializer
+	// Initializers
 	character() = default;
+	explicit character(std::pmr::memory_resource* arena) : entity(arena) {}
 
 	// Add a feature or add to history based on an input string
-	void addFeature(std::string featString, std::vector<std::string>& history);
+	void addFeature(std::string_view featString, std::vector<rosterString>& history);
 
-	// Output the character
-	std::string output() const;
+	// Write the character into a sink
+	void output(support::outputSink& out) const;
 };
 
-// Group List Information
-class groupList {
+// Name to Position Index for an entity list
+class nameIndex {
 public:
-	std::vector<unit> groups;     // Contains all groups
+	// Empty the index
+	void clear();
+	// Note a name's position, keeping the first position of a repeated name
+	void add(const symbol& name, int position);
+	// Forget a name's position, moving a repeated name on to its next position
+	void remove(const symbol& name, int position, int next);
+
+	// Return a name's position, -1 if it was never added
+	int find(const symbol& name) const;
+	// Return how many entities hold a name
+	int occurrences(const symbol& name) const;
+	// Return how many entities were indexed
+	size_t count() const { return indexed; }
+
+private:
+	// First position and number of entities holding a name
+	struct slot {
+		int position;
+		int count;
+	};
 
+	std::unordered_map<symbol, slot> positions;
+	size_t indexed = 0;
+};
+
+// Entity Store, keeping entities in list order behind generational handles
+template <typename T>
+class entityStore {
+public:
+	// Stable reference to an entity, which stops resolving once the entity is removed
+	struct handle {
+		uint32_t slot = UINT32_MAX;
+		uint32_t generation = 0;
+	};
+
+	// Return the entities in list order, where removed entities stay as tombstones until the next reindex
+	// Readers iterating the list during a batch of removals skip positions for which removed() holds
+	std::vector<T>& entities() { return items; }
+	const std::vector<T>& entities() const { return items; }
+	// Return whether a list is this store's entity list
+	bool holds(const std::vector<T>& list) const { return &list == &items; }
+
+	// Add an entity to the end of the list
+	handle add(T ent);
+	// Remove an entity in constant time, leaving a tombstone until the next reindex
+	void remove(handle ent);
+	// Return whether the entity at a position was removed
+	bool removed(int position) const;
+	// Return whether every entity in the list has a handle
+	bool tracked() const { return slotOf.size() == items.size(); }
+	// Return the number of removed entities still in the list
+	size_t tombstones() const { return dropped; }
+
+	// Return the handle of the first live entity with a name, a handle to nothing if there is none
+	handle find(const symbol& name) const;
+	// Return the handle of the entity at a position
+	handle at(int position) const;
+	// Return the position behind a handle, -1 once its entity is removed
+	int position(handle ent) const;
+	// Return the entity behind a handle, nullptr once it is removed
+	T* get(handle ent);
+
+	// Drop the tombstones, hand out handles for entities added straight to the list and rebuild the name index
+	void reindex();
+
+	nameIndex index;		// Positions of all live entities by name
+
+private:
+	// Position of a handle's entity and the generation of the handles that still reach it
+	struct slotRecord {
+		int position;
+		uint32_t generation;
+	};
+
+	static constexpr uint32_t noSlot = UINT32_MAX;
+
+	// Hand out a slot for a position, reusing a freed slot first
+	uint32_t newSlot(int position);
+
+	std::vector<T> items;
+	std::vector<uint32_t> slotOf;		// Slot of each position, noSlot once removed
+	std::vector<slotRecord> slots;
+	std::vector<uint32_t> freeSlots;
+	size_t dropped = 0;
+};
+
+// Group List Information
+class groupList : public entityStore<unit> {
+public:
 	std::vector<std::string> ranks;		// Contains all group ranks
 };
 
 // Character List Information
-class characterList {
+class characterList : public entityStore<character> {
 public:
-	std::vector<character> characters;	// Contains all characters
-
 	std::vector<std::string> ranks;		// Contains all character ranks
-	std::vector<std::string> other;     // Contains all characters' unlabeled data
+	std::vector<rosterString> other;     // Contains all characters' unlabeled data
 
 	std::vector<feature> features;		// Contains all possible character features
+	std::vector<std::vector<std::string>> tags;		// Contains all character tags
 };
 
-struct {
-	/*
-	struct Tag{
-		std::string name;
-		int weight;
-		std::string desc;
+// Sparse Relation Graph, holding the entities each character relates to in compressed rows
+class relationGraph {
+public:
+	// Range of node indices
+	struct nodeRange {
+		const int* first;
+		const int* last;
+
+		const int* begin() const { return first; }
+		const int* end() const { return last; }
+		size_t size() const { return last - first; }
 	};
-	std::vector<Tag> bonds;		// Contains all possible relation tags
-	*/
-	std::vector<unit> groups;     // Contains all groups
 
-	std::vector<std::string> ranks;		// Contains all group ranks
-} GroupList;
+	// Build the graph, with character nodes first and unit nodes after
+	relationGraph(const std::vector<character>& characterList, const std::vector<unit>& unitList);
+
+	// Return the number of nodes
+	size_t size() const { return names.size(); }
+	// Return a node's name
+	const symbol& name(int node) const { return names[node]; }
+	// Return the first node with a name, -1 if there is none
+	int find(const symbol& name) const;
+
+	// Return the nodes a node relates to, in relation order, skipping missing entities
+	nodeRange related(int node) const;
+	// Return the nodes relating to a node, in ascending order
+	nodeRange relatedBy(int node) const;
+
+private:
+	std::vector<symbol> names;
+	std::unordered_map<symbol, int> nodes;
+
+	// Outgoing and incoming edges, each node's edges starting at its offset
+	std::vector<int> outOffsets, outTargets;
+	std::vector<int> inOffsets, inSources;
+};
+
+// Unit Hierarchy, holding the characters belonging to each unit name
+// The units below each unit come from the ancestor index, which also cuts membership cycles
+class unitHierarchy {
+public:
+	// Build the hierarchy of a character list
+	void build(const std::vector<character>& characterList);
+	// Drop the hierarchy, so the next use rebuilds it
+	void invalidate() { built = false; }
+	// Return whether the hierarchy was built from a list of this size
+	bool current(size_t charSize) const { return built && characterCount == charSize; }
+
+	// Move a character to another unit after its membership changes
+	void moveCharacter(int position, const symbol& from, const symbol& to);
+	// File a character appended to the end of the list
+	void addCharacter(int position, const symbol& member);
+	// Unfile a removed character, whose tombstone keeps its position until the next build
+	void removeCharacter(int position, const symbol& member);
+
+	// Return the positions of the characters belonging to a unit, in list order
+	const std::vector<int>& characters(const symbol& name) const;
+
+private:
+	// Move a position from one member list to another, keeping both in list order
+	static void move(std::unordered_map<symbol, std::vector<int>>& members, int position, const symbol& from, const symbol& to);
+	// Remove a position from a unit's member list
+	static void drop(std::unordered_map<symbol, std::vector<int>>& members, int position, const symbol& from);
+
+	bool built = false;
+	size_t characterCount = 0;
+
+	std::unordered_map<symbol, std::vector<int>> characterMembers;	// Characters belonging to each unit name
+};
+
+// Ancestor Index over Unit Memberships, cutting membership cycles so every walk ends
+class unitAncestors {
+public:
+	// Range of unit positions
+	struct positionRange {
+		const int* first;
+		const int* last;
+
+		const int* begin() const { return first; }
+		const int* end() const { return last; }
+		size_t size() const { return last - first; }
+	};
+
+	// Build the index of a unit list
+	void build(const std::vector<unit>& unitList);
+	// Drop the index, so the next use rebuilds it
+	void invalidate() { built = false; }
+	// Return whether the index was built from a list of this size
+	bool current(size_t unitSize) const { return built && unitCount == unitSize; }
+
+	// Return the first position of a unit name, -1 if there is none
+	int find(const symbol& name) const;
+	// Return the position of the unit a unit belongs to, -1 for none
+	int parent(int position) const { return parents[position]; }
+	// Return the number of units above a unit
+	int depth(int position) const { return depths[position]; }
+	// Return the positions of the units above a unit, nearest first
+	std::vector<int> ancestors(int position) const;
+	// Return the positions of the units directly below a unit in list order, with every cycle already cut
+	positionRange children(int position) const;
+	// Return whether a unit sits anywhere below another
+	bool isUnder(int position, int ancestor) const;
+
+	// Return every position in preorder, each unit before the units below it
+	const std::vector<int>& preorder() const { return order; }
+
+	// Return the membership cycles found while building, each starting from the unit whose link was cut
+	const std::vector<std::vector<int>>& cycles() const { return loops; }
+
+private:
+	bool built = false;
+	size_t unitCount = 0;
+
+	std::unordered_map<symbol, int> positions;	// First position of each unit name
+	std::vector<int> parents;					// Position of each unit's parent
+	std::vector<int> depths;					// Depth of each unit
+	std::vector<int> enter, leave;				// Preorder interval of each unit's subtree
+	std::vector<int> childOffsets, childList;	// Children of each unit in compressed rows
+	std::vector<int> order;						// Positions in preorder
+	std::vector<std::vector<int>> loops;
+};
+
+// Unit Sizes, counting the characters in each unit and in every unit below it
+class unitSizes {
+public:
+	// Build the sizes of a roster, bottom-up over its ancestor index
+	void build(const std::vector<character>& characterList, const unitAncestors& tree);
+	// Drop the sizes, so the next use rebuilds them
+	void invalidate() { built = false; }
+	// Return whether the sizes were built from lists of these sizes
+	bool current(size_t charSize, size_t unitSize) const;
+
+	// Move a character between units, updating only the units above each
+	void moveCharacter(const unitAncestors& tree, const symbol& from, const symbol& to);
+	// Count a character appended to the end of its list
+	void addCharacter(const unitAncestors& tree, int position, const symbol& member);
+	// Stop counting a removed character, whose tombstone keeps its position until the next build
+	void removeCharacter(const unitAncestors& tree, const symbol& member);
+
+	// Return the characters belonging directly to a unit
+	int direct(int position) const { return directCounts[position]; }
+	// Return the characters in a unit and every unit below it
+	int total(int position) const { return totalCounts[position]; }
+
+	// Return whether a size is within the bounds of a rank, 2^r to 3 * 2^(r - 1)
+	static bool fits(int rank, int size);
+	// Return the most members a rank holds, from the same bounds, 0 past the largest rank
+	static int capacity(int rank);
+
+private:
+	// Add to the total of a unit and every unit above it
+	void addTotal(const unitAncestors& tree, int position, int count);
+
+	bool built = false;
+	size_t characterCount = 0;
+
+	std::vector<int> directCounts;
+	std::vector<int> totalCounts;
+};
 
-struct {
-	struct Tag {
-		std::string name;
-		std::string desc;
+// Rank Buckets, holding the characters and units of each rank in list order
+class rankIndex {
+public:
+	// Build the buckets of a roster
+	void build(const std::vector<character>& characterList, const std::vector<unit>& unitList);
+	// Drop the buckets, so the next use rebuilds them
+	void invalidate() { built = false; }
+	// Return whether the buckets were built from lists of these sizes
+	bool current(size_t charSize, size_t unitSize) const;
+
+	// Refile an entity under its current rank
+	void updateCharacter(int position, int rank);
+	void updateUnit(int position, int rank);
+	// File an entity appended to the end of its list
+	void addCharacter(int position, int rank);
+	void addUnit(int position, int rank);
+	// Unfile a removed entity, whose tombstone keeps its position until the next build
+	void removeCharacter(int position);
+	void removeUnit(int position);
+
+	// Return one past the highest rank held
+	int characterRanks() const { return characterBuckets.positions.size(); }
+	int unitRanks() const { return unitBuckets.positions.size(); }
+
+	// Return the positions of the characters or units of a rank, in list order
+	const std::vector<int>& characters(int rank) const;
+	const std::vector<int>& units(int rank) const;
+
+private:
+	// Positions filed under each rank, and the rank each position is filed under
+	struct buckets {
+		std::vector<std::vector<int>> positions;
+		std::vector<int> ranks;
 	};
 
-	std::vector<character> characters;	// Contains all characters
+	// File every position of a list under its rank
+	template <typename T>
+	static void fill(buckets& list, const std::vector<T>& entities);
+	// Move a position to another rank, keeping both buckets in list order
+	static void move(buckets& list, int position, int rank);
+	// File a position appended to the end of a list
+	static void append(buckets& list, int position, int rank);
+	// Remove a position from its rank, leaving it filed under none
+	static void drop(buckets& list, int position);
+	// Return the positions of a rank, empty past the highest rank
+	static const std::vector<int>& bucket(const buckets& list, int rank);
+
+	bool built = false;
+
+	buckets characterBuckets;
+	buckets unitBuckets;
+};
 
-	std::vector<std::string> ranks;		// Contains all character ranks
-	std::vector<std::string> other;     // Contains all characters' unlabeled data
+// Inverted Index over Relation Tags, holding every relation that carries each tag
+class tagIndex {
+public:
+	// Relation carrying a tag
+	struct posting {
+		int source;			// Position of the character holding the relation
+		int relation;		// Position of the relation in the character's relations
+		symbol target;		// Name the relation refers to
+	};
 
-	std::vector<std::vector<std::string>> tags;		// Contains all character tags
-} CharacterList;
+	// Build the index of a character list
+	void build(const std::vector<character>& characterList);
+	// Drop the index, so the next use rebuilds it
+	void invalidate() { built = false; }
+	// Return whether the index was built from a list of this size
+	bool current(size_t charSize) const { return built && characterCount == charSize; }
+
+	// Refile a character's relations after they are edited
+	void update(const std::vector<character>& characterList, int position);
+	// File the relations of a character appended to the end of the list
+	void insert(const std::vector<character>& characterList, int position);
+	// Unfile the relations of a removed character, whose tombstone keeps its position until the next build
+	void remove(int position);
+
+	// Return the relations carrying a tag, in list order
+	const std::vector<posting>& tagged(const symbol& tag) const;
+	// Return every tag carried by at least one relation, in alphabetical order
+	std::vector<symbol> tags() const;
+
+private:
+	// File the relations of a character, keeping each tag's postings in list order
+	void add(const character& chara, int position);
+	// Drop the postings filed for a character
+	void drop(int position);
+
+	bool built = false;
+	size_t characterCount = 0;
+
+	std::unordered_map<symbol, std::vector<posting>> postings;		// Relations carrying each tag
+	std::vector<std::vector<symbol>> sourceTags;					// Tags filed for each character
+};
+
+// Save Cache, holding a hash of each entity file's content so saves only write changed entities
+class saveCache {
+public:
+	// Return whether an entity file's content matches the file as last read or saved
+	// A file is read from disk the first time it is compared, and a missing file never matches
+	bool unchanged(const std::string& path, std::string_view content);
+	// Note the content an entity file now holds
+	void note(const std::string& path, std::string_view content);
+	// Forget an entity file whose save failed, so the next save writes it again
+	void forget(const std::string& path);
+
+	// Return the file an entity is saved to
+	static std::string path(const character& chara);
+	static std::string path(const unit& uni);
+
+	// Write the content saved to an entity's file, ahead of its spare lines
+	static void serialize(support::outputSink& out, const character& chara);
+	static void serialize(support::outputSink& out, const unit& uni);
+
+private:
+	// Hash content with 64-bit FNV-1a
+	static uint64_t hash(std::string_view content);
+
+	std::unordered_map<std::string, uint64_t> fileHashes;
+};
+
+// Save Writer, writing entity files on background threads so saves don't hold up the menu
+class saveWriter {
+public:
+	// Start the writing threads
+	saveWriter(unsigned int threadCount);
+	// Finish every queued write, then stop the threads
+	~saveWriter();
+
+	// Queue content for a file, replacing any queued content the file hasn't started writing
+	void submit(std::string path, std::string content);
+	// Block until every queued write has finished
+	void wait();
+	// Print the writes finished since the last report, forgetting the failed files in the cache
+	void report(saveCache& saved);
+
+private:
+	// Content queued for a file
+	struct writeJob {
+		std::string path;
+		std::string content;
+	};
+
+	// Most files written before their contents are flushed together
+	static constexpr int batchSize = 32;
+
+	// Run a writing thread
+	void work();
+	// Write a batch of files, returning the paths that failed
+	static std::vector<std::string> writeBatch(std::vector<writeJob>& batch);
+
+	std::mutex lock;
+	std::condition_variable wake, idle;
+	std::map<std::string, std::string> pending;
+	std::set<std::string> writing;
+	bool stopping = false;
+
+	int written = 0;
+	std::vector<std::string> failed;
+	std::vector<std::thread> threads;
+};
+
+// Binary Roster Cache, read on start up in place of the text files and copied into the lists
+class rosterImage {
+public:
+	// Default location of the image
+	static constexpr const char* defaultPath = "Roster-Image.bin";
 
+	// Reference to a string in the image's string pool
+	struct stringRef {
+		uint32_t offset;
+		uint32_t size;
+	};
+
+	// Character or unit record
+	struct entityRecord {
+		stringRef name;
+		stringRef member;
+		stringRef source;
+		int32_t rank;
+		int32_t historyIndex;
+		uint32_t aspectBegin, aspectCount;
+		uint32_t relationBegin, relationCount;
+	};
+
+	// Relation record
+	struct relationRecord {
+		stringRef name;
+		stringRef desc;
+		uint32_t tagBegin, tagCount;
+	};
+
+	// Parameter tag record
+	struct paramTagRecord {
+		stringRef name;
+		stringRef desc;
+	};
+
+	// Source file the image was built from
+	struct sourceRecord {
+		stringRef path;
+		uint64_t size;
+		int64_t modified;
+	};
+
+	// Identity of a source file at the time it was read
+	struct sourceFile {
+		std::string path;
+		uint64_t size;
+		int64_t modified;
+	};
+
+	// List the parameter document and every file in the entity directories, as they are now
+	static std::vector<sourceFile> currentSources();
+
+	// Map an image, failing if it is missing, malformed or out of date with its source files
+	bool open(const std::string& path);
+	// Write an image of the lists, stamped with the source files as they were before the lists were read
+	static bool write(const std::string& path, const std::vector<sourceFile>& sourceList, const characterList& charList, const groupList& unitList);
+
+	// Copy the image's contents into the lists
+	void load(characterList& charList, groupList& unitList) const;
+
+private:
+	// Access the image's records
+	size_t characterCount() const;
+	size_t unitCount() const;
+	const entityRecord& characterAt(int index) const;
+	const entityRecord& unitAt(int index) const;
+	std::string_view aspectAt(const entityRecord& ent, int index) const;
+	const relationRecord& relationAt(const entityRecord& ent, int index) const;
+	std::string_view tagAt(const relationRecord& rel, int index) const;
+	std::string_view text(const stringRef& ref) const;
+
+	// Sections of the image, in file order
+	enum section { sources, characters, units, aspects, relations, tags, history, paramTags, characterRanks, groupRanks, strings, sectionCount };
+
+	// Image header, followed by the sections
+	struct header {
+		char magic[4];
+		uint32_t version;
+		uint64_t offset[sectionCount];
+		uint64_t count[sectionCount];
+	};
+
+	// Access a section as an array
+	template <typename T>
+	const T* table(section sec) const;
+
+	// Confirm every record only references data inside the image
+	bool checkBounds() const;
+
+	support::mappedFile file;
+	const header* head = nullptr;
+};
+
+// Arena holding the shared lists' text, defined in Source.cpp ahead of the lists so it outlives them
+// Text freed by a reload returns to the arena's pools for reuse, and every chunk is released with the arena
+extern std::pmr::synchronized_pool_resource RosterArena;
+
+// Shared lists, defined in Source.cpp
+extern groupList GroupList;
+extern characterList CharacterList;
+
+
+// Problem Found While Validating the Roster
+struct diagnostic {
+	// Problems the validation reports
+	enum problemType { missingUnit, missingCharacter, selfMembership, duplicateName };
+
+	problemType problem;
+	symbol entity;			// Entity with the problem
+	bool unitEntity;		// Whether the entity is a unit
+	const char* field;		// Field holding the offending value
+	symbol value;			// Offending value
+};
+
+// Cached Validation of the Shared Lists, rechecking only the names edited since the last check
+class validationCache {
+public:
+	// Note an edit to the entities holding a name
+	void markDirty(const symbol& name);
+
+	// Return the number of edits noted so far
+	uint64_t generation() const { return edits; }
+
+	// Return every problem in the lists in roster order, rechecking the edited names and the entities referencing them
+	const std::vector<diagnostic>& check(const characterList& charList, const groupList& unitList, unsigned int threadCount = 1);
+
+private:
+	// Validate the whole roster, replacing the cache
+	void rebuild(const characterList& charList, const groupList& unitList, unsigned int threadCount);
+	// Recheck every entity holding a name
+	void recheck(const symbol& name, const characterList& charList, const groupList& unitList);
+
+	// Note a name referenced by the entities holding another name
+	void addReference(const symbol& name, const symbol& target);
+
+	bool built = false;
+	uint64_t edits = 0;
+	uint64_t checked = 0;
+
+	std::unordered_set<symbol> dirty;									// Names edited since the last check
+	std::unordered_map<symbol, std::vector<diagnostic>> problems;		// Problems of the entities holding each name
+	std::unordered_map<symbol, std::vector<symbol>> references;			// Names the entities holding each name reference
+	std::unordered_map<symbol, std::unordered_set<symbol>> referencedBy;	// Names of the entities referencing each name
+
+	std::vector<diagnostic> results;
+};
+
+// Cached validation of the shared lists, defined in Source.cpp
+extern validationCache RosterValidation;
+// Hierarchy of the shared lists, defined in Source.cpp
+extern unitHierarchy RosterHierarchy;
+// Ancestors of the shared unit list, defined in Source.cpp
+extern unitAncestors RosterAncestors;
+// Unit sizes of the shared lists, defined in Source.cpp
+extern unitSizes RosterSizes;
+// Relation tags of the shared character list, defined in Source.cpp
+extern tagIndex RosterTags;
+// Rank buckets of the shared lists, defined in Source.cpp
+extern rankIndex RosterRanks;
+// Saved file contents of the shared lists, defined in Source.cpp
+extern saveCache RosterSaves;
 
 namespace interactions {
+	// Validate the roster in one pass, returning every problem in roster order
+	std::vector<diagnostic> validate(const std::vector<character>& characterList, const std::vector<unit>& unitList, unsigned int threadCount = 1);
+	// Validate the live entities of two stores, skipping their tombstones
+	std::vector<diagnostic> validate(const entityStore<character>& charStore, const entityStore<unit>& unitStore, unsigned int threadCount = 1);
+
 	// Verify all members in the character and unit list
-	std::set<std::string> verifyMemberships(std::vector<character> characterList, std::vector<unit> unitList);
+	std::set<std::string> verifyMemberships(const std::vector<character>& characterList, const std::vector<unit>& unitList);
 
 	// Verify that all relations in a character list exist in the list
-	std::set<std::string> verifyRelations(std::vector<character> list);
+	std::set<std::string> verifyRelations(const std::vector<character>& list);
+
+	// Note an edited entity of the shared lists, doing nothing for any other list
+	void markEdited(const std::vector<character>& arr, const symbol& name);
+	void markEdited(const std::vector<unit>& arr, const symbol& name);
+	// Note a possibly changed membership of the shared lists, doing nothing for any other list
+	void markMoved(const std::vector<character>& arr, int position, const symbol& from);
+	void markMoved(const std::vector<unit>& arr, int position, const symbol& from);
+	// Note an entity appended to the shared lists, doing nothing for any other list
+	void markAdded(const std::vector<character>& arr, int position);
+	void markAdded(const std::vector<unit>& arr, int position);
+	// Note an entity of the shared lists about to be removed, doing nothing for any other list
+	void markRemoved(const std::vector<character>& arr, int position);
+	void markRemoved(const std::vector<unit>& arr, int position);
+
+	// Print each problem found while validating the roster
+	void printProblems(const std::vector<diagnostic>& diagnostics);
 
 	// Verify the size of all units
-	void verifySizes(std::vector<character> characterList, std::vector<unit> unitList);
+	void verifySizes(const std::vector<character>& characterList, const std::vector<unit>& unitList);
 
-	// Write list contents to their respective files
-	void writeToFile(std::vector<character> characterList, std::vector<unit> unitList);
+	// Queue the changed entities to be written to their respective files in the background, skipping those loaded from markdown files
+	void writeToFile(const std::vector<character>& characterList, const std::vector<unit>& unitList, saveWriter& writer);
 }
 
 namespace modifyRelations {
@@ -141,22 +773,27 @@ namespace modifyRelations {
 
 namespace missingEntity{
 	// Refactor a character
-	void refacChar(const std::string& missingChar, std::vector<character>& characterList);
+	void refacChar(const symbol& missingChar, entityStore<character>& characterStore);
 	// Refactor a unit
-	void refacUnit(const std::string& missingUnit, std::vector<character>& characterList, std::vector<unit>& unitList);
+	void refacUnit(const symbol& missingUnit, entityStore<character>& characterStore, entityStore<unit>& unitStore);
 
-	// Delete a selected character
-	void deleteChar(const std::string& missingChar, std::vector<character>& characterList);
-	// Delete a selected unit
-	void deleteUnit(const std::string& missingUnit, std::vector<character>& characterList, std::vector<unit>& unitList);
+	// Delete a selected character, leaving its tombstone until the caller compacts the store
+	void deleteChar(const symbol& missingChar, entityStore<character>& characterStore);
+	// Delete a selected unit, leaving its tombstone until the caller compacts the store
+	void deleteUnit(const symbol& missingUnit, entityStore<character>& characterStore, entityStore<unit>& unitStore);
 
 	// Rename all characters
-	void renameChar(const std::string& missingChar, std::vector<character>& characterList);
+	void renameChar(const symbol& missingChar, std::vector<character>& characterList);
 	// Rename all units
-	void renameUnit(const std::string& missingUnit, std::vector<character>& characterList, std::vector<unit>& unitList);
+	void renameUnit(const symbol& missingUnit, std::vector<character>& characterList, std::vector<unit>& unitList);
 
 	// Split a unit into other units
-	void splitUnit(const std::string& missingUnit, std::vector<character>& characterList, std::vector<unit>& unitList);
+	void splitUnit(const symbol& missingUnit, std::vector<character>& characterList, std::vector<unit>& unitList);
+
+	// Refactor every entity named in a document in one pass, reading lines of
+	// "Rename Character: Old: New", "Delete Character: Old", "Rename Unit: Old: New",
+	// "Delete Unit: Old" and "Split Unit: Old: Member: New"
+	void refacBatch(const std::string& file, entityStore<character>& characterStore, entityStore<unit>& unitStore);
 }
 
 namespace input {
@@ -164,22 +801,47 @@ namespace input {
 	std::vector<std::string> splitDelim(std::string input);
 	// Split a string based on a list of delims
 	std::vector<std::string> splitDelim(std::string input, std::vector<std::string> delimList);
+	// Split a string view based on the standard delims, reusing the parts buffer
+	void splitDelim(std::string_view input, std::vector<std::string_view>& parts);
+	// Split a string view based on a precompiled list of delims, reusing the parts buffer
+	void splitDelim(std::string_view input, const support::delimSplitter& delims, std::vector<std::string_view>& parts);
 
 	// Load a character from a file
-	void loadChar(std::string file, std::vector<character>& characterList, std::vector<std::string>& history);
+	void loadChar(std::string file, std::vector<character>& characterList, std::vector<rosterString>& history);
 	// Load a unit from a file
-	void loadUnit(std::string file, std::vector<unit>& unitList, std::vector<std::string>& history);
+	void loadUnit(std::string file, std::vector<unit>& unitList, std::vector<rosterString>& history);
+
+	// Load a character from a memory mapped file
+	void loadCharMapped(std::string file, std::vector<character>& characterList, std::vector<rosterString>& history);
+	// Load a unit from a memory mapped file
+	void loadUnitMapped(std::string file, std::vector<unit>& unitList, std::vector<rosterString>& history);
+	// Load a character from a file read without mapping, for a file that may be truncated while it loads
+	void loadCharRead(std::string file, std::vector<character>& characterList, std::vector<rosterString>& history);
+	// Load a unit from a file read without mapping, for a file that may be truncated while it loads
+	void loadUnitRead(std::string file, std::vector<unit>& unitList, std::vector<rosterString>& history);
+
+	// Load a list of character files across threads, merging in list order and skipping any file that fails to load
+	void loadCharFiles(const std::vector<std::string>& files, std::vector<character>& characterList, std::vector<rosterString>& history, unsigned int threadCount);
+	// Load a list of unit files across threads, merging in list order and skipping any file that fails to load
+	void loadUnitFiles(const std::vector<std::string>& files, std::vector<unit>& unitList, std::vector<rosterString>& history, unsigned int threadCount);
+}
+
+namespace watch {
+	// Watch the character and unit directories, reloading changed files until input is entered
+	void watchFiles(characterList& chars, groupList& groups);
 }
 
 namespace output {
 	// Print all in the provided vectors
 	void printAll(const std::vector<character>& characterList, const std::vector<unit>& unitList);
 	// Print according to rank
-	void printRank(std::vector<character> characterList, std::vector<unit> unitList);
+	void printRank(const std::vector<character>& characterList, const std::vector<unit>& unitList);
 	// Full print according to a vector of rules
 	void printFull(const std::vector<character>& characterList, const std::vector<unit>& unitList);
-	// Write the character and unit list to two seperate markdown files
-	void logListsMD(const std::vector<character>& characterList, const std::vector<unit>& unitList, const std::vector<std::string>& history);
+	// Write the character and unit list to two seperate markdown files, formatting across threads
+	void logListsMD(const std::vector<character>& characterList, const std::vector<unit>& unitList, const std::vector<rosterString>& history, unsigned int threadCount = 1);
+	// Stream the characters, then the units, to an NDJSON file holding one JSON object per line
+	void logListsNDJSON(const std::vector<character>& characterList, const std::vector<unit>& unitList, const std::vector<rosterString>& history);
 
 	// Print out the character and all member unit information
 	void charPrintFull(const character& acter, const std::vector<unit>& unitList);
@@ -189,6 +851,9 @@ namespace output {
 
 	// Print multiple characters or units, chosen randomly
 	void multiPrint(const std::vector<character>& characterList, const std::vector<unit>& unitList);
+
+	// Print every relation carrying a chosen tag, optionally only those towards a unit's characters
+	void printTagged(const std::vector<character>& characterList, const std::vector<unit>& unitList);
 }
 
 namespace rules {
@@ -199,6 +864,28 @@ namespace rules {
 }
 
 namespace simpleFind {
-	int find(const std::vector<character>& arr, const std::string& val);
-	int find(const std::vector<unit>& arr, const std::string& val);
+	// Find by name, through the shared list's index when given the shared list
+	template <typename T>
+	int find(const std::vector<T>& arr, const symbol& val);
+
+	// Reindex the shared list's store and drop the indexes built over it, doing nothing for any other list
+	template <typename T>
+	void reindex(const std::vector<T>& arr);
+	// Reindex a store, dropping the indexes built over it when it is a shared list
+	template <typename T>
+	void reindex(entityStore<T>& store);
+	// Reindex a store once a batch of removals is done, doing nothing when it holds no tombstones
+	template <typename T>
+	void compact(entityStore<T>& store);
+
+	// Return the shared character list's hierarchy, building any other list's hierarchy into scratch
+	const unitHierarchy& hierarchy(const std::vector<character>& arr, unitHierarchy& scratch);
+	// Return the shared unit list's ancestors, building any other list's ancestors into scratch
+	const unitAncestors& ancestors(const std::vector<unit>& arr, unitAncestors& scratch);
+	// Return the shared lists' unit sizes, building any other lists' sizes into scratch
+	const unitSizes& sizes(const std::vector<character>& charArr, const std::vector<unit>& unitArr, unitSizes& scratch);
+	// Return the shared character list's relation tags, building any other list's tags into scratch
+	const tagIndex& tags(const std::vector<character>& arr, tagIndex& scratch);
+	// Return the shared lists' rank buckets, building any other lists' buckets into scratch
+	const rankIndex& ranks(const std::vector<character>& charArr, const std::vector<unit>& unitArr, rankIndex& scratch);
 }
\ No newline at end of file
@@ -1,12 +1,79 @@
 #include "pch.h"
 #include "CppUnitTest.h"
-#include "../CharacterTracker/Classes.h"
-#include "../CharacterTracker/General.h"
-#include "../CharacterTracker/Classes.cpp"
+#include <random>
+#include <sstream>
+#include <limits>
+#include <cmath>
+#include <filesystem>
+#include "../CharacterTracker/Tracker.h"
 #include "../CharacterTracker/General.cpp"
+#include "../CharacterTracker/Tracker-Class-Ancestors.cpp"
+#include "../CharacterTracker/Tracker-Class-Character.cpp"
+#include "../CharacterTracker/Tracker-Class-Entity.cpp"
+#include "../CharacterTracker/Tracker-Class-Graph.cpp"
+#include "../CharacterTracker/Tracker-Class-Hierarchy.cpp"
+#include "../CharacterTracker/Tracker-Class-Image.cpp"
+#include "../CharacterTracker/Tracker-Class-Ranks.cpp"
+#include "../CharacterTracker/Tracker-Class-Saves.cpp"
+#include "../CharacterTracker/Tracker-Class-Sizes.cpp"
+#include "../CharacterTracker/Tracker-Class-Store.cpp"
+#include "../CharacterTracker/Tracker-Class-Symbol.cpp"
+#include "../CharacterTracker/Tracker-Class-Tags.cpp"
+#include "../CharacterTracker/Tracker-Class-Unit.cpp"
+#include "../CharacterTracker/Tracker-Class-Validation.cpp"
+#include "../CharacterTracker/Tracker-Class-Writer.cpp"
+#include "../CharacterTracker/Tracker-Namespaces-IO.cpp"
+#include "../CharacterTracker/Tracker-Namespaces-Interact.cpp"
+#include "../CharacterTracker/Tracker-Namespaces-Missing.cpp"
+#include "../CharacterTracker/Tracker-Namespaces-Relations.cpp"
+#include "../CharacterTracker/Tracker-Namespaces-Support.cpp"
+#include "../CharacterTracker/Tracker-Namespaces-Watch.cpp"
 
 using namespace Microsoft::VisualStudio::CppUnitTestFramework;
 
+// Shared roster state, defined by Source.cpp in the program itself
+std::pmr::synchronized_pool_resource RosterArena;
+groupList GroupList;
+characterList CharacterList;
+validationCache RosterValidation;
+unitHierarchy RosterHierarchy;
+unitAncestors RosterAncestors;
+unitSizes RosterSizes;
+tagIndex RosterTags;
+rankIndex RosterRanks;
+saveCache RosterSaves;
+
+// Build a relation towards a named character
+entity::tagFeature makeRelation(const std::string& name, const std::string& desc) {
+	entity::tagFeature relation;
+	relation.name = symbol(name);
+	relation.desc = desc;
+	return relation;
+}
+
+// Fill a random roster from a small pool of names, so names repeat, go missing and refer to themselves
+void randomRoster(std::mt19937& rng, std::vector<character>& charList, std::vector<unit>& unitList) {
+	int charCount = rng() % 12, unitCount = rng() % 4;
+	int pool = charCount + unitCount + 3;
+	auto randomName = [&]() { return symbol("Name " + std::to_string(rng() % pool)); };
+
+	charList.assign(charCount, character());
+	unitList.assign(unitCount, unit());
+
+	for (character& chara : charList) {
+		chara.name = randomName();
+		chara.member = rng() % 3 == 0 ? symbol::none : randomName();
+
+		for (int i = rng() % 5; i > 0; i--)
+			chara.relations.push_back(makeRelation(randomName().str(), "Test"));
+	}
+
+	for (unit& uni : unitList) {
+		uni.name = randomName();
+		uni.member = rng() % 3 == 0 ? symbol::none : randomName();
+	}
+}
+
 namespace Basic_Error_Test
 {
 	TEST_CLASS(Three_Unit_Three_Character)
@@ -20,20 +87,26 @@ namespace Basic_Error_Test
 				charList.push_back(character());
 				unitList.push_back(unit());
 			}
+
+			// Name the ranks the entities default to
+			CharacterList.ranks = { "Rank 0" };
+			GroupList.ranks = { "Rank 0" };
 		}
 
 		TEST_METHOD(Basic_Print)
 		{
 			init();
 			try {
+				support::outputSink out(std::cout);
+
 				// Print all characters
-				for (character entry : charList) {
-					entry.print();
+				for (const character& entry : charList) {
+					entry.output(out);
 				}
 
 				// Print all units
-				for (unit entry : unitList) {
-					entry.print();
+				for (const unit& entry : unitList) {
+					entry.output(out);
 				}
 			}
 			// If any exception is thrown, fail
@@ -47,8 +120,8 @@ namespace Basic_Error_Test
 			init();
 			try {
 				// Print all characters
-				for (character entry : charList) {
-					entry.fullprint(unitList);
+				for (const character& entry : charList) {
+					output::charPrintFull(entry, unitList);
 				}
 			}
 			// If any exception is thrown, fail
@@ -64,9 +137,8 @@ namespace Basic_Error_Test
 				// Verify the units and characters
 				interactions::verifyMemberships(charList, unitList);
 				interactions::verifyRelations(charList);
-				interactions::verifyRelations(unitList);
 				interactions::verifySizes(charList, unitList);
-				interactions::addMissingRelations(charList, unitList);
+				modifyRelations::addMissingRelations(charList, unitList);
 			}
 			// If any exception is thrown, fail
 			catch (...) {
@@ -84,20 +156,26 @@ namespace Basic_Error_Test
 		void init() {
 			charList.push_back(character());
 			unitList.push_back(unit());
+
+			// Name the ranks the entities default to
+			CharacterList.ranks = { "Rank 0" };
+			GroupList.ranks = { "Rank 0" };
 		}
 
 		TEST_METHOD(Basic_Print)
 		{
 			init();
 			try {
+				support::outputSink out(std::cout);
+
 				// Print all characters
-				for (character entry : charList) {
-					entry.print();
+				for (const character& entry : charList) {
+					entry.output(out);
 				}
 
 				// Print all units
-				for (unit entry : unitList) {
-					entry.print();
+				for (const unit& entry : unitList) {
+					entry.output(out);
 				}
 			}
 			// If any exception is thrown, fail
@@ -111,8 +189,8 @@ namespace Basic_Error_Test
 			init();
 			try {
 				// Print all characters
-				for (character entry : charList) {
-					entry.fullprint(unitList);
+				for (const character& entry : charList) {
+					output::charPrintFull(entry, unitList);
 				}
 			}
 			// If any exception is thrown, fail
@@ -128,9 +206,8 @@ namespace Basic_Error_Test
 				// Verify the units and characters
 				interactions::verifyMemberships(charList, unitList);
 				interactions::verifyRelations(charList);
-				interactions::verifyRelations(unitList);
 				interactions::verifySizes(charList, unitList);
-				interactions::addMissingRelations(charList, unitList);
+				modifyRelations::addMissingRelations(charList, unitList);
 			}
 			// If any exception is thrown, fail
 			catch (...) {
@@ -151,9 +228,8 @@ namespace Basic_Error_Test
 				// Verify the units and characters
 				interactions::verifyMemberships(charList, unitList);
 				interactions::verifyRelations(charList);
-				interactions::verifyRelations(unitList);
 				interactions::verifySizes(charList, unitList);
-				interactions::addMissingRelations(charList, unitList);
+				modifyRelations::addMissingRelations(charList, unitList);
 			}
 			// If any exception is thrown, fail
 			catch (...) {
@@ -178,14 +254,14 @@ namespace Verify_Test
 			}
 
 			// Set Unit Names
-			unitList[0].name = "Unit 0";
-			unitList[1].name = "Unit 1";
-			unitList[2].name = "Unit 2";
+			unitList[0].name = symbol("Unit 0");
+			unitList[1].name = symbol("Unit 1");
+			unitList[2].name = symbol("Unit 2");
 
 			// Set Character Names
-			charList[0].name = "Character 0";
-			charList[1].name = "Character 1";
-			charList[2].name = "Character 2";
+			charList[0].name = symbol("Character 0");
+			charList[1].name = symbol("Character 1");
+			charList[2].name = symbol("Character 2");
 		}
 
 		TEST_METHOD(Verify_Membership)
@@ -193,13 +269,13 @@ namespace Verify_Test
 			init();
 
 			// Set valid memberships
-			charList[0].member = "Unit 0";
-			charList[1].member = "Unit 2";
-			unitList[0].member = "Unit 1";
+			charList[0].member = symbol("Unit 0");
+			charList[1].member = symbol("Unit 2");
+			unitList[0].member = symbol("Unit 1");
 
 			// Set invalid memberships
-			charList[2].member = "Unit 3";
-			unitList[1].member = "Unit 3";
+			charList[2].member = symbol("Unit 3");
+			unitList[1].member = symbol("Unit 3");
 
 			// Run the verify
 			std::set<std::string> returnErr = interactions::verifyMemberships(charList, unitList);
@@ -229,14 +305,14 @@ namespace Verify_Test
 			init();
 
 			// Set valid relations
-			charList[0].relations.push_back({ "Character 1", "Test" });
-			charList[0].relations.push_back({ "Character 2", "Test" });
-			charList[1].relations.push_back({ "Character 0", "Test" });
-			charList[2].relations.push_back({ "Character 0", "Test" });
+			charList[0].relations.push_back(makeRelation("Character 1", "Test"));
+			charList[0].relations.push_back(makeRelation("Character 2", "Test"));
+			charList[1].relations.push_back(makeRelation("Character 0", "Test"));
+			charList[2].relations.push_back(makeRelation("Character 0", "Test"));
 
 			// Set invalid relations
-			charList[0].relations.push_back({ "Character 3", "Test" });
-			charList[1].relations.push_back({ "Character 3", "Test" });
+			charList[0].relations.push_back(makeRelation("Character 3", "Test"));
+			charList[1].relations.push_back(makeRelation("Character 3", "Test"));
 
 			// Run the verify
 			std::set<std::string> returnErr = interactions::verifyRelations(charList);
@@ -261,41 +337,1891 @@ namespace Verify_Test
 			Assert::IsTrue(errLoc == returnErr.end());
 		}
 
-		TEST_METHOD(Verify_Unit_Relations)
+		TEST_METHOD(Verify_Unit_Membership)
 		{
 			init();
 
-			// Set valid relations
-			unitList[0].relations.push_back({ "Unit 1", "Test" });
-			unitList[0].relations.push_back({ "Unit 2", "Test" });
-			unitList[1].relations.push_back({ "Unit 0", "Test" });
-			unitList[2].relations.push_back({ "Unit 0", "Test" });
+			// Set valid memberships, units holding no relations of their own
+			unitList[0].member = symbol("Unit 1");
+			unitList[1].member = symbol("Unit 2");
 
-			// Set invalid relations
-			unitList[1].relations.push_back({ "Unit 3", "Test" });
-			unitList[2].relations.push_back({ "Unit 3", "Test" });
+			// Set an invalid membership
+			unitList[2].member = symbol("Unit 3");
 
-			// Run the verify
-			std::set<std::string> returnErr = interactions::verifyRelations(unitList);
+			// Run the verify over the units alone
+			std::set<std::string> returnErr = interactions::verifyMemberships({}, unitList);
 
 			// Try to find the invalid membership in the returned set
-			Logger::WriteMessage("Invalid Relation Check");
-			auto errLoc = returnErr.find("Unit 3");
-			Assert::IsTrue(errLoc != returnErr.end());
+			Logger::WriteMessage("Invalid Membership Check");
+			Assert::IsTrue(returnErr.size() == 1);
+			Assert::IsTrue(returnErr.find("Unit 3") != returnErr.end());
 
 			// Verify valid memberships aren't in the set
-			Logger::WriteMessage("\nValid Relation Check");
-			errLoc = returnErr.find("Unit 0");
-			Assert::IsTrue(errLoc == returnErr.end());
-			errLoc = returnErr.find("Unit 1");
-			Assert::IsTrue(errLoc == returnErr.end());
-			errLoc = returnErr.find("Unit 2");
-			Assert::IsTrue(errLoc == returnErr.end());
+			Logger::WriteMessage("\nValid Membership Check");
+			Assert::IsTrue(returnErr.find("Unit 1") == returnErr.end());
+			Assert::IsTrue(returnErr.find("Unit 2") == returnErr.end());
+		}
 
-			// Verify unknown memberships aren't in the set
-			Logger::WriteMessage("\nRandom Relation Check");
-			errLoc = returnErr.find("Unit 4");
-			Assert::IsTrue(errLoc == returnErr.end());
+		TEST_METHOD(Validate_Diagnostics)
+		{
+			init();
+
+			// Set a unit belonging to itself, a repeated character name and a missing unit
+			unitList[0].member = symbol("Unit 0");
+			charList[1].name = symbol("Character 0");
+			charList[2].member = symbol("Unit 3");
+
+			// Run the validation
+			std::vector<diagnostic> diagnostics = interactions::validate(charList, unitList);
+
+			// Expect each problem once, repeated names first and the rest in roster order
+			Assert::AreEqual(size_t(3), diagnostics.size());
+
+			Assert::IsTrue(diagnostics[0].problem == diagnostic::duplicateName);
+			Assert::IsTrue(diagnostics[0].entity == symbol("Character 0"));
+
+			Assert::IsTrue(diagnostics[1].problem == diagnostic::missingUnit);
+			Assert::IsTrue(diagnostics[1].entity == symbol("Character 2"));
+			Assert::IsTrue(diagnostics[1].value == symbol("Unit 3"));
+
+			Assert::IsTrue(diagnostics[2].problem == diagnostic::selfMembership);
+			Assert::IsTrue(diagnostics[2].entity == symbol("Unit 0") && diagnostics[2].unitEntity);
+		}
+	};
+
+	TEST_CLASS(Random_Rosters)
+	{
+	public:
+		// Report missing memberships by searching the names linearly, as before the single pass
+		static std::set<std::string> linearMemberships(const std::vector<character>& characterList, const std::vector<unit>& unitList) {
+			std::vector<symbol> unitNames = { symbol::none };
+			std::set<std::string> returnList;
+
+			for (const unit& uni : unitList)
+				unitNames.push_back(uni.name);
+
+			for (const character& chara : characterList)
+				if (std::find(unitNames.begin(), unitNames.end(), chara.member) == unitNames.end())
+					returnList.insert(chara.member.str());
+
+			for (const unit& uni : unitList)
+				if (std::find(unitNames.begin(), unitNames.end(), uni.member) == unitNames.end())
+					returnList.insert(uni.member.str());
+
+			return returnList;
+		}
+
+		// Report missing relations by searching the names linearly, as before the single pass
+		static std::set<std::string> linearRelations(const std::vector<character>& list) {
+			std::vector<symbol> charNames;
+			std::set<std::string> returnList;
+
+			for (const character& chara : list)
+				charNames.push_back(chara.name);
+
+			for (const character& chara : list)
+				for (const entity::tagFeature& relation : chara.relations)
+					if (std::find(charNames.begin(), charNames.end(), relation.name) == charNames.end())
+						returnList.insert(relation.name.str());
+
+			return returnList;
+		}
+
+		TEST_METHOD(Validate_Matches_Linear_Search)
+		{
+			std::mt19937 rng(12);
+
+			for (int roster = 0; roster < 2000; roster++) {
+				std::vector<character> charList;
+				std::vector<unit> unitList;
+				randomRoster(rng, charList, unitList);
+
+				Assert::IsTrue(interactions::verifyMemberships(charList, unitList) == linearMemberships(charList, unitList));
+				Assert::IsTrue(interactions::verifyRelations(charList) == linearRelations(charList));
+			}
+		}
+
+		TEST_METHOD(Threads_Match_One_Thread)
+		{
+			// Repeat small rosters past the size checked across threads
+			std::mt19937 rng(12);
+			std::vector<character> charList;
+			std::vector<unit> unitList;
+
+			while (charList.size() + unitList.size() < (1 << 15)) {
+				std::vector<character> chars;
+				std::vector<unit> units;
+				randomRoster(rng, chars, units);
+
+				charList.insert(charList.end(), chars.begin(), chars.end());
+				unitList.insert(unitList.end(), units.begin(), units.end());
+			}
+
+			// Expect the same diagnostics in the same order
+			std::vector<diagnostic> serial = interactions::validate(charList, unitList, 1);
+			std::vector<diagnostic> threaded = interactions::validate(charList, unitList, 4);
+
+			Assert::AreEqual(serial.size(), threaded.size());
+			for (int i = 0; i < serial.size(); i++) {
+				Assert::IsTrue(serial[i].problem == threaded[i].problem && serial[i].unitEntity == threaded[i].unitEntity);
+				Assert::IsTrue(serial[i].entity == threaded[i].entity && serial[i].value == threaded[i].value);
+			}
+		}
+	};
+
+	TEST_CLASS(Validation_Cache)
+	{
+	public:
+		// Expect two lists of diagnostics to match in order
+		static void assertSame(const std::vector<diagnostic>& expected, const std::vector<diagnostic>& actual) {
+			Assert::AreEqual(expected.size(), actual.size());
+			for (size_t i = 0; i < expected.size(); i++) {
+				Assert::IsTrue(expected[i].problem == actual[i].problem && expected[i].unitEntity == actual[i].unitEntity);
+				Assert::IsTrue(expected[i].entity == actual[i].entity && expected[i].value == actual[i].value);
+			}
+		}
+
+		TEST_METHOD(Roster_Order_Without_Tombstones)
+		{
+			// Fill the lists with a problem on every other entity and no repeated names
+			characterList chars;
+			groupList groups;
+
+			for (int i = 0; i < 40; i++) {
+				character chara;
+				chara.name = symbol("Cache Character " + std::to_string(i));
+				chara.member = i % 2 == 0 ? symbol("Cache Missing " + std::to_string(i)) : symbol::none;
+				chars.add(chara);
+
+				unit uni;
+				uni.name = symbol("Cache Unit " + std::to_string(i));
+				uni.member = i % 2 == 0 ? uni.name : symbol::none;
+				groups.add(uni);
+			}
+
+			// Expect the problems in roster order, as a single pass finds them
+			validationCache cache;
+			assertSame(interactions::validate(chars, groups), cache.check(chars, groups));
+
+			// Edit a single entity, so only its name is rechecked
+			chars.entities()[1].member = symbol("Cache Missing 1");
+			cache.markDirty(chars.entities()[1].name);
+			assertSame(interactions::validate(chars, groups), cache.check(chars, groups));
+
+			// Remove entities holding problems, leaving tombstones behind
+			for (int i : { 0, 2, 4, 6, 8, 10 }) {
+				cache.markDirty(chars.entities()[i].name);
+				chars.remove(chars.at(i));
+			}
+
+			// Expect both the recheck and a full rebuild to leave the tombstones out
+			validationCache fresh;
+			std::vector<diagnostic> found = cache.check(chars, groups);
+
+			assertSame(interactions::validate(chars, groups), found);
+			assertSame(found, fresh.check(chars, groups));
+			Assert::AreEqual(size_t(20 + 20 - 6 + 1), found.size());
+
+			for (const diagnostic& diag : found)
+				Assert::IsFalse(diag.entity == symbol("Cache Character 0"));
+		}
+	};
+}
+
+namespace Relation_Test
+{
+	TEST_CLASS(Missing_Relations)
+	{
+	public:
+		// Add missing relations through the dense relation matrix the graph replaced
+		static void matrixMissingRelations(std::vector<character>& characterList, const std::vector<unit>& unitList) {
+			size_t entitySize = characterList.size() + unitList.size();
+			std::vector<symbol> names;
+
+			for (const character& chara : characterList)
+				names.push_back(chara.name);
+			for (const unit& uni : unitList)
+				names.push_back(uni.name);
+
+			// Mark each relation both ways, against the first entity of its name
+			std::vector<std::vector<bool>> relationMatrix(entitySize, std::vector<bool>(entitySize, false));
+			for (int i = 0; i < characterList.size(); i++) {
+				for (const entity::tagFeature& relation : characterList[i].relations) {
+					auto relPos = std::find(names.begin(), names.end(), relation.name);
+					if (relPos != names.end()) {
+						relationMatrix[i][relPos - names.begin()] = true;
+						relationMatrix[relPos - names.begin()][i] = true;
+					}
+				}
+			}
+
+			// Add every marked entity a character doesn't already name
+			for (int i = 0; i < characterList.size(); i++) {
+				std::vector<symbol> relateNames;
+				for (const entity::tagFeature& relation : characterList[i].relations)
+					relateNames.push_back(relation.name);
+
+				for (int j = 0; j < entitySize; j++) {
+					if (relationMatrix[i][j] && std::find(relateNames.begin(), relateNames.end(), names[j]) == relateNames.end())
+						characterList[i].relations.push_back(makeRelation(names[j].str(), "New Relation"));
+				}
+			}
+		}
+
+		TEST_METHOD(Graph_Matches_Matrix)
+		{
+			std::mt19937 rng(11);
+
+			for (int roster = 0; roster < 2000; roster++) {
+				std::vector<character> charList, expected;
+				std::vector<unit> unitList;
+				randomRoster(rng, charList, unitList);
+
+				// Add the relations both ways
+				expected = charList;
+				matrixMissingRelations(expected, unitList);
+				modifyRelations::addMissingRelations(charList, unitList);
+
+				// Expect the same relations in the same order
+				Assert::AreEqual(expected.size(), charList.size());
+				for (int i = 0; i < charList.size(); i++) {
+					Assert::AreEqual(expected[i].relations.size(), charList[i].relations.size());
+
+					for (int j = 0; j < charList[i].relations.size(); j++) {
+						Assert::IsTrue(expected[i].relations[j].name == charList[i].relations[j].name);
+						Assert::IsTrue(expected[i].relations[j].desc == charList[i].relations[j].desc);
+					}
+				}
+			}
+		}
+	};
+}
+
+namespace Split_Test
+{
+	TEST_CLASS(Delim_Split)
+	{
+	public:
+		TEST_METHOD(Generic_Delims)
+		{
+			// Split on the earliest delim, preferring earlier delims in the list on a tie
+			std::vector<std::string> parts = support::splitByDelim("Relation: Name <tag, other> Desc - More");
+			std::vector<std::string> expected = { "Relation", "Name", "tag, other", "Desc", "More" };
+			Assert::IsTrue(parts == expected);
+
+			// A line without delims stays whole
+			parts = support::splitByDelim("Plain history line");
+			Assert::IsTrue(parts.size() == 1 && parts[0] == "Plain history line");
+
+			// Trailing delims leave an empty part
+			parts = support::splitByDelim("Rank: ");
+			expected = { "Rank", "" };
+			Assert::IsTrue(parts == expected);
+		}
+
+		TEST_METHOD(Custom_Delims)
+		{
+			// Reuse a precompiled splitter and buffer of views
+			support::delimSplitter tagDelims({ ", ", ",", " , ", " ," });
+			std::vector<std::string_view> parts;
+
+			support::splitByDelim("ally, friend,rival , foe", tagDelims, parts);
+			Assert::IsTrue(parts.size() == 4);
+			Assert::IsTrue(parts[0] == "ally" && parts[1] == "friend" && parts[2] == "rival" && parts[3] == "foe");
+		}
+	};
+}
+
+namespace Find_Test
+{
+	TEST_CLASS(Name_Index)
+	{
+	public:
+		TEST_METHOD(Shared_List_Lookup)
+		{
+			// Index the shared character list
+			CharacterList.entities().clear();
+			for (std::string name : { "Char 1", "Char 2", "Char 1" }) {
+				character chara;
+				chara.name = symbol(name);
+				CharacterList.entities().push_back(chara);
+			}
+			CharacterList.reindex();
+
+			// A repeated name finds its first position, like a front to back search
+			Assert::AreEqual(0, simpleFind::find(CharacterList.entities(), symbol("Char 1")));
+			Assert::AreEqual(1, simpleFind::find(CharacterList.entities(), symbol("Char 2")));
+			Assert::AreEqual(-1, simpleFind::find(CharacterList.entities(), symbol("Char 3")));
+
+			// A stale index still finds names added since it was built
+			character added;
+			added.name = symbol("Char 3");
+			CharacterList.entities().push_back(added);
+			Assert::AreEqual(3, simpleFind::find(CharacterList.entities(), symbol("Char 3")));
+
+			CharacterList.entities().clear();
+			CharacterList.reindex();
+		}
+	};
+}
+
+namespace Store_Test
+{
+	TEST_CLASS(Entity_Store)
+	{
+	public:
+		TEST_METHOD(Handles_Survive_Compaction)
+		{
+			// Fill a store
+			entityStore<unit> store;
+			std::vector<entityStore<unit>::handle> handles;
+			for (std::string name : { "Unit 1", "Unit 2", "Unit 3" }) {
+				unit uni;
+				uni.name = symbol(name);
+				handles.push_back(store.add(uni));
+			}
+
+			// A removed entity stops resolving and can't be found
+			store.remove(handles[1]);
+			Assert::IsTrue(store.get(handles[1]) == nullptr);
+			Assert::IsTrue(store.removed(1));
+			Assert::AreEqual(-1, store.position(store.find(symbol("Unit 2"))));
+
+			// The others keep resolving as the list is compacted
+			store.reindex();
+			Assert::AreEqual(2, (int)store.entities().size());
+			Assert::AreEqual(1, store.position(handles[2]));
+			Assert::IsTrue(store.get(handles[2])->name == symbol("Unit 3"));
+			Assert::IsTrue(store.get(handles[1]) == nullptr);
+		}
+	};
+}
+
+namespace Tag_Test
+{
+	TEST_CLASS(Tag_Index)
+	{
+	public:
+		// Give each relation a few tags from a small pool, repeats included
+		static void randomTags(std::mt19937& rng, character& chara) {
+			for (entity::tagFeature& relation : chara.relations) {
+				relation.tags.clear();
+				for (int i = rng() % 4; i > 0; i--)
+					relation.tags.emplace_back("tag " + std::to_string(rng() % 4));
+			}
+		}
+
+		// Collect the relations carrying a tag by scanning every relation, as before the index
+		static std::vector<tagIndex::posting> scanTagged(const std::vector<character>& characterList, const std::string& tag) {
+			std::vector<tagIndex::posting> found;
+
+			for (int i = 0; i < characterList.size(); i++)
+				for (int j = 0; j < characterList[i].relations.size(); j++) {
+					const entity::tagFeature& relation = characterList[i].relations[j];
+					if (std::find(relation.tags.begin(), relation.tags.end(), std::string_view(tag)) != relation.tags.end())
+						found.push_back({ i, j, relation.name });
+				}
+
+			return found;
+		}
+
+		// Expect the index to hold exactly what a scan finds
+		static void matchScan(const tagIndex& index, const std::vector<character>& characterList) {
+			std::set<std::string> scanned;
+			for (const character& chara : characterList)
+				for (const entity::tagFeature& relation : chara.relations)
+					scanned.insert(relation.tags.begin(), relation.tags.end());
+
+			std::vector<symbol> tags = index.tags();
+			Assert::AreEqual(scanned.size(), tags.size());
+
+			for (const std::string& tag : scanned) {
+				Assert::IsTrue(std::find(tags.begin(), tags.end(), symbol(tag)) != tags.end());
+
+				std::vector<tagIndex::posting> expected = scanTagged(characterList, tag);
+				const std::vector<tagIndex::posting>& postings = index.tagged(symbol(tag));
+
+				Assert::AreEqual(expected.size(), postings.size());
+				for (int i = 0; i < expected.size(); i++) {
+					Assert::AreEqual(expected[i].source, postings[i].source);
+					Assert::AreEqual(expected[i].relation, postings[i].relation);
+					Assert::IsTrue(expected[i].target == postings[i].target);
+				}
+			}
+		}
+
+		TEST_METHOD(Index_Matches_Scan)
+		{
+			std::mt19937 rng(19);
+
+			for (int roster = 0; roster < 1000; roster++) {
+				std::vector<character> charList;
+				std::vector<unit> unitList;
+				randomRoster(rng, charList, unitList);
+				for (character& chara : charList)
+					randomTags(rng, chara);
+
+				tagIndex index;
+				index.build(charList);
+				matchScan(index, charList);
+
+				// Retag a few characters, refiling each in place
+				for (int edit = 0; edit < 3 && !charList.empty(); edit++) {
+					int position = rng() % charList.size();
+					randomTags(rng, charList[position]);
+					index.update(charList, position);
+				}
+
+				matchScan(index, charList);
+			}
+		}
+	};
+}
+
+namespace Sink_Test
+{
+	TEST_CLASS(Output_Sink)
+	{
+	public:
+		TEST_METHOD(Matches_Stream_Formatting)
+		{
+			std::mt19937 rng(20);
+			std::uniform_real_distribution<double> mantissa(-10, 10);
+
+			// Write the same values to a stream, a sink over a stream and a sink without one
+			std::ostringstream expected, written;
+			std::string taken;
+			{
+				support::outputSink out(written, 7);
+				support::outputSink buffered;
+
+				auto both = [&](auto value) {
+					expected << value;
+					out << value;
+					buffered << value;
+				};
+
+				// Bounds and signed zero, then random values of every magnitude
+				for (int value : { 0, -1, 1, std::numeric_limits<int>::max(), std::numeric_limits<int>::min() })
+					both(value);
+				for (double value : { 0.0, -0.0, 0.5, 1e-5, 123456.0, 1234567.0, 1e100, -1e-100 })
+					both(value);
+
+				for (int i = 0; i < 20000; i++) {
+					switch (rng() % 4) {
+					case 0: both(int(rng())); break;
+					case 1: both(mantissa(rng) * std::pow(10.0, int(rng() % 40) - 20)); break;
+					case 2: both(char('a' + rng() % 26)); break;
+					case 3: both(std::string(rng() % 12, ' ') + "text"); break;
+					}
+					both(' ');
+				}
+
+				taken = buffered.take();
+			}
+
+			Assert::IsTrue(expected.str() == written.str());
+			Assert::IsTrue(expected.str() == taken);
+		}
+	};
+}
+
+namespace Rank_Test
+{
+	TEST_CLASS(Rank_Buckets)
+	{
+	public:
+		// Order a list's positions by rank with a stable sort, as before the buckets
+		template <typename T>
+		static std::vector<int> sortedByRank(const std::vector<T>& list) {
+			std::vector<int> positions(list.size());
+			for (int i = 0; i < list.size(); i++)
+				positions[i] = i;
+
+			std::stable_sort(positions.begin(), positions.end(), [&](int a, int b) { return list[a].rank < list[b].rank; });
+			return positions;
+		}
+
+		// Expect walking the buckets in rank order to visit the positions in sorted order
+		static void matchSort(const rankIndex& ranks, const std::vector<character>& charList, const std::vector<unit>& unitList) {
+			std::vector<int> charWalk, unitWalk;
+
+			for (int rank = 0; rank < ranks.characterRanks(); rank++)
+				for (int pos : ranks.characters(rank)) {
+					Assert::AreEqual(rank, charList[pos].rank);
+					charWalk.push_back(pos);
+				}
+
+			for (int rank = 0; rank < ranks.unitRanks(); rank++)
+				for (int pos : ranks.units(rank)) {
+					Assert::AreEqual(rank, unitList[pos].rank);
+					unitWalk.push_back(pos);
+				}
+
+			Assert::IsTrue(charWalk == sortedByRank(charList));
+			Assert::IsTrue(unitWalk == sortedByRank(unitList));
+		}
+
+		TEST_METHOD(Buckets_Match_Stable_Sort)
+		{
+			std::mt19937 rng(21);
+
+			for (int roster = 0; roster < 1000; roster++) {
+				std::vector<character> charList;
+				std::vector<unit> unitList;
+				randomRoster(rng, charList, unitList);
+
+				for (character& chara : charList)
+					chara.rank = rng() % 6;
+				for (unit& uni : unitList)
+					uni.rank = rng() % 6;
+
+				rankIndex ranks;
+				ranks.build(charList, unitList);
+				matchSort(ranks, charList, unitList);
+
+				// Rerank a few entities, refiling each in place
+				for (int edit = 0; edit < 4; edit++) {
+					if (!charList.empty()) {
+						int position = rng() % charList.size();
+						charList[position].rank = rng() % 8;
+						ranks.updateCharacter(position, charList[position].rank);
+					}
+
+					if (!unitList.empty()) {
+						int position = rng() % unitList.size();
+						unitList[position].rank = rng() % 8;
+						ranks.updateUnit(position, unitList[position].rank);
+					}
+				}
+
+				matchSort(ranks, charList, unitList);
+			}
+		}
+
+		TEST_METHOD(Empty_Roster_And_Ties)
+		{
+			// An empty roster holds no ranks, and every rank reads as empty
+			std::vector<character> charList;
+			std::vector<unit> unitList;
+
+			rankIndex ranks;
+			ranks.build(charList, unitList);
+			Assert::AreEqual(0, ranks.characterRanks());
+			Assert::AreEqual(0, ranks.unitRanks());
+			Assert::IsTrue(ranks.characters(0).empty());
+			Assert::IsTrue(ranks.units(3).empty());
+
+			// Entities sharing a rank stay in list order as they are filed in
+			for (int i = 0; i < 6; i++) {
+				charList.emplace_back();
+				charList.back().rank = 1;
+				ranks.addCharacter(i, 1);
+			}
+			Assert::IsTrue(ranks.characters(1) == std::vector<int>({ 0, 1, 2, 3, 4, 5 }));
+			Assert::IsTrue(ranks.characters(0).empty());
+
+			// Moving away and back, or being removed, keeps the others in list order
+			ranks.updateCharacter(4, 0);
+			ranks.updateCharacter(1, 0);
+			ranks.updateCharacter(4, 1);
+			ranks.removeCharacter(2);
+			Assert::IsTrue(ranks.characters(0) == std::vector<int>({ 1 }));
+			Assert::IsTrue(ranks.characters(1) == std::vector<int>({ 0, 3, 4, 5 }));
+		}
+	};
+}
+
+namespace Markdown_Test
+{
+	TEST_CLASS(Markdown_Export)
+	{
+	public:
+		// Read a whole file, removing it afterwards
+		static std::string readAndRemove(const std::string& path) {
+			std::ifstream inFile(path, std::ios::binary);
+			std::string contents((std::istreambuf_iterator<char>(inFile)), std::istreambuf_iterator<char>());
+			inFile.close();
+
+			std::remove(path.c_str());
+			return contents;
+		}
+
+		TEST_METHOD(Threads_Match_One_Thread)
+		{
+			// Repeat small rosters into one long enough for many chunks, with aspects, history and ranks
+			std::mt19937 rng(22);
+			std::vector<character> charList;
+			std::vector<unit> unitList;
+			std::vector<rosterString> history;
+			GroupList.ranks = { "Rank 0", "Rank 1", "Rank 2" };
+
+			while (charList.size() < 5000) {
+				std::vector<character> chars;
+				std::vector<unit> units;
+				randomRoster(rng, chars, units);
+
+				for (character& chara : chars) {
+					chara.aspects.emplace_back("Aspect " + std::to_string(rng() % 10));
+					if (rng() % 2 == 0) {
+						chara.historyIndex = history.size();
+						history.emplace_back("Note " + std::to_string(history.size()) + "\n");
+					}
+				}
+
+				for (unit& uni : units)
+					uni.rank = rng() % GroupList.ranks.size();
+
+				charList.insert(charList.end(), chars.begin(), chars.end());
+				unitList.insert(unitList.end(), units.begin(), units.end());
+			}
+
+			// Write the export on one thread, then on four
+			output::logListsMD(charList, unitList, history, 1);
+			std::string serialChars = readAndRemove("characterMD.md");
+			std::string serialUnits = readAndRemove("unitMD.md");
+
+			output::logListsMD(charList, unitList, history, 4);
+			std::string threadedChars = readAndRemove("characterMD.md");
+			std::string threadedUnits = readAndRemove("unitMD.md");
+
+			// Expect the same bytes
+			Assert::IsFalse(serialChars.empty());
+			Assert::IsTrue(serialChars == threadedChars);
+			Assert::IsTrue(serialUnits == threadedUnits);
+		}
+
+		TEST_METHOD(Empty_And_Short_Lists)
+		{
+			GroupList.ranks = { "Rank 0" };
+
+			// Empty lists still write both files, empty, whatever the thread count
+			std::remove("characterMD.md");
+			std::remove("unitMD.md");
+			output::logListsMD({}, {}, {}, 4);
+
+			Assert::IsTrue(std::filesystem::exists("characterMD.md"));
+			Assert::IsTrue(std::filesystem::exists("unitMD.md"));
+			Assert::IsTrue(readAndRemove("characterMD.md").empty());
+			Assert::IsTrue(readAndRemove("unitMD.md").empty());
+
+			// Lists shorter than one chunk give the same bytes on more threads than chunks
+			character chara;
+			chara.name = symbol("Char A");
+			unit uni;
+			uni.name = symbol("Unit A");
+
+			output::logListsMD({ chara }, { uni }, {}, 1);
+			std::string serialChars = readAndRemove("characterMD.md");
+			std::string serialUnits = readAndRemove("unitMD.md");
+
+			output::logListsMD({ chara }, { uni }, {}, 8);
+			Assert::IsTrue(serialChars == readAndRemove("characterMD.md"));
+			Assert::IsTrue(serialUnits == readAndRemove("unitMD.md"));
+			Assert::IsTrue(serialChars.compare(0, 9, "# Char A\n") == 0);
+		}
+	};
+}
+
+namespace Save_Test
+{
+	TEST_CLASS(Save_Cache)
+	{
+	public:
+		// Format a character's saved lines with a stream, as every save did before the cache
+		static std::string streamCharacter(const character& chara) {
+			std::ostringstream out;
+			out << "Rank: " << CharacterList.ranks[chara.rank] << "\n";
+			out << "Member: " << chara.member << "\n";
+			for (const rosterString& aspect : chara.aspects)
+				out << "Aspect: " << aspect << "\n";
+			for (const entity::tagFeature& relation : chara.relations)
+				out << "Relation: " << relation.name << ": " << relation.desc << "\n";
+			return out.str();
+		}
+
+		// Format a unit's saved lines with a stream, as every save did before the cache
+		static std::string streamUnit(const unit& uni) {
+			std::ostringstream out;
+			out << "Rank: " << GroupList.ranks[uni.rank] << "\n";
+			out << "Member: " << uni.member << "\n";
+			for (const rosterString& aspect : uni.aspects)
+				out << "Aspect: " << aspect << "\n";
+			return out.str();
+		}
+
+		TEST_METHOD(Serialize_Matches_Stream)
+		{
+			std::mt19937 rng(23);
+			CharacterList.ranks = { "Rank 0", "Rank 1" };
+			GroupList.ranks = { "Rank 0", "Rank 1", "Rank 2" };
+			support::outputSink out;
+
+			for (int roster = 0; roster < 1000; roster++) {
+				std::vector<character> charList;
+				std::vector<unit> unitList;
+				randomRoster(rng, charList, unitList);
+
+				for (character& chara : charList) {
+					chara.rank = rng() % CharacterList.ranks.size();
+					chara.aspects.emplace_back("Aspect " + std::to_string(rng() % 10));
+
+					saveCache::serialize(out, chara);
+					Assert::IsTrue(out.take() == streamCharacter(chara));
+				}
+
+				for (unit& uni : unitList) {
+					uni.rank = rng() % GroupList.ranks.size();
+
+					saveCache::serialize(out, uni);
+					Assert::IsTrue(out.take() == streamUnit(uni));
+				}
+			}
+		}
+
+		TEST_METHOD(Tagged_Relations_Read_Back)
+		{
+			CharacterList.ranks = { "Rank 0" };
+
+			// A relation without tags, one with a tag and one with several
+			character chara;
+			chara.relations.push_back(makeRelation("Char A", "Friend"));
+			chara.relations.push_back(makeRelation("Char B", "Rival"));
+			chara.relations[1].tags.emplace_back("old");
+			chara.relations.push_back(makeRelation("Char C", "Sibling"));
+			chara.relations[2].tags.emplace_back("family");
+			chara.relations[2].tags.emplace_back("close");
+
+			support::outputSink out;
+			saveCache::serialize(out, chara);
+			std::string content = out.take();
+
+			// Untagged relations keep the form every build wrote, tagged ones carry their tags
+			Assert::IsTrue(content.find("Relation: Char A: Friend\n") != std::string::npos);
+			Assert::IsTrue(content.find("Relation: Char B <old> Rival\n") != std::string::npos);
+			Assert::IsTrue(content.find("Relation: Char C <family,close> Sibling\n") != std::string::npos);
+
+			// Expect loading the lines to give back every relation and tag
+			character loaded;
+			std::vector<rosterString> history;
+			std::istringstream lines(content);
+			std::string line;
+			while (getline(lines, line))
+				loaded.addFeature(line, history);
+
+			Assert::AreEqual(chara.relations.size(), loaded.relations.size());
+			for (size_t i = 0; i < chara.relations.size(); i++) {
+				Assert::IsTrue(chara.relations[i].name == loaded.relations[i].name);
+				Assert::IsTrue(chara.relations[i].desc == loaded.relations[i].desc);
+				Assert::IsTrue(chara.relations[i].tags == loaded.relations[i].tags);
+			}
+		}
+
+		TEST_METHOD(Unchanged_Reads_The_File)
+		{
+			const std::string path = "saveCacheTest.txt";
+			const std::string content = "Rank: Rank 0\nMember: None\nAspect: Brave\n";
+
+			// A missing file never matches
+			std::remove(path.c_str());
+			saveCache missing;
+			Assert::IsFalse(missing.unchanged(path, content));
+
+			// A file holding the content matches, ignoring the spare lines a save carries over
+			{
+				std::ofstream outFile(path);
+				outFile << content << "A spare line\n";
+			}
+
+			saveCache saved;
+			Assert::IsTrue(saved.unchanged(path, content));
+			Assert::IsFalse(saved.unchanged(path, content + "Aspect: Bold\n"));
+
+			// Noted content replaces the file's, until it is forgotten
+			saved.note(path, content + "Aspect: Bold\n");
+			Assert::IsTrue(saved.unchanged(path, content + "Aspect: Bold\n"));
+			Assert::IsFalse(saved.unchanged(path, content));
+
+			saved.forget(path);
+			Assert::IsTrue(saved.unchanged(path, content));
+
+			std::remove(path.c_str());
+		}
+
+		TEST_METHOD(Empty_Content_And_Missing_Folders)
+		{
+			const std::string path = "saveCacheTest.txt";
+
+			// A file of only spare lines, or none at all, holds empty content
+			{
+				std::ofstream outFile(path);
+				outFile << "A spare line\n";
+			}
+			saveCache spare;
+			Assert::IsTrue(spare.unchanged(path, ""));
+			Assert::IsFalse(spare.unchanged(path, "Rank: Rank 0\n"));
+
+			{
+				std::ofstream outFile(path);
+			}
+			saveCache empty;
+			Assert::IsTrue(empty.unchanged(path, ""));
+			std::remove(path.c_str());
+
+			// A file whose folder is missing never matches, even empty content, and comparing it creates nothing
+			std::filesystem::remove_all("saveCacheMissing");
+			saveCache missing;
+			Assert::IsFalse(missing.unchanged("saveCacheMissing/File.txt", ""));
+			Assert::IsFalse(std::filesystem::exists("saveCacheMissing"));
+
+			// Saving empty lists queues nothing
+			std::ostringstream printed;
+			std::streambuf* previousOut = std::cout.rdbuf(printed.rdbuf());
+			{
+				saveWriter writer(1);
+				interactions::writeToFile({}, {}, writer);
+				writer.wait();
+			}
+			std::cout.rdbuf(previousOut);
+
+			Assert::AreEqual(std::string("Saving 0 changed entities.\n\n"), printed.str());
+		}
+	};
+}
+
+namespace Writer_Test
+{
+	TEST_CLASS(Save_Writer)
+	{
+	public:
+		// Read a whole file
+		static std::string readFile(const std::string& path) {
+			std::ifstream inFile(path, std::ios::binary);
+			return std::string((std::istreambuf_iterator<char>(inFile)), std::istreambuf_iterator<char>());
+		}
+
+		TEST_METHOD(Matches_Direct_Write)
+		{
+			const std::string folder = "saveWriterTest";
+			std::filesystem::remove_all(folder);
+			std::filesystem::create_directory(folder);
+
+			// Give every other file spare lines for the save to carry over
+			std::vector<std::string> paths, contents, expected;
+			for (int i = 0; i < 200; i++) {
+				paths.push_back(folder + "/File " + std::to_string(i) + ".txt");
+				contents.push_back("Rank: Rank " + std::to_string(i) + "\nMember: None\n");
+				std::string spare = i % 2 == 0 ? "Spare line " + std::to_string(i) + "\n" : "";
+
+				if (!spare.empty()) {
+					std::ofstream outFile(paths[i]);
+					outFile << "Rank: Old\n" << spare;
+				}
+
+				// The file a direct write gives, the content followed by the spare lines
+				expected.push_back(contents[i] + spare);
+			}
+
+			{
+				saveWriter writer(4);
+
+				// Queue stale content first, so the later submit replaces or follows it
+				for (int i = 0; i < paths.size(); i++)
+					writer.submit(paths[i], "Rank: Stale\n");
+				for (int i = 0; i < paths.size(); i++)
+					writer.submit(paths[i], contents[i]);
+
+				writer.wait();
+			}
+
+			// Expect each file to hold only its latest content, with no temporary files left
+			for (int i = 0; i < paths.size(); i++)
+				Assert::IsTrue(readFile(paths[i]) == expected[i]);
+
+			int fileCount = 0;
+			for (const auto& file : std::filesystem::directory_iterator(folder)) {
+				Assert::IsTrue(file.path().extension() != ".tmp");
+				fileCount++;
+			}
+			Assert::AreEqual(200, fileCount);
+
+			std::filesystem::remove_all(folder);
+		}
+
+		TEST_METHOD(Failed_Write_Is_Forgotten)
+		{
+			const std::string path = "saveWriterMissing/File.txt";
+			const std::string content = "Rank: Rank 0\n";
+			std::filesystem::remove_all("saveWriterMissing");
+
+			// Note the content as a save does, then fail to write it
+			saveCache saved;
+			saved.note(path, content);
+
+			saveWriter writer(1);
+			writer.submit(path, content);
+			writer.wait();
+			writer.report(saved);
+
+			// The next save compares against the missing file, writing it again
+			Assert::IsFalse(saved.unchanged(path, content));
+		}
+
+		TEST_METHOD(Empty_Content_And_Idle_Writer)
+		{
+			const std::string folder = "saveWriterEmpty";
+			std::filesystem::remove_all(folder);
+			std::filesystem::create_directory(folder);
+
+			{
+				std::ofstream outFile(folder + "/Spare.txt");
+				outFile << "Rank: Old\nSpare line\n";
+			}
+
+			std::ostringstream printed;
+			std::streambuf* previousOut = std::cout.rdbuf(printed.rdbuf());
+			{
+				saveWriter writer(2);
+
+				// Waiting on and reporting an idle writer returns at once, printing nothing
+				saveCache saved;
+				writer.wait();
+				writer.report(saved);
+				Assert::IsTrue(printed.str().empty());
+
+				// Empty content creates an empty file, or leaves only the spare lines
+				writer.submit(folder + "/New.txt", "");
+				writer.submit(folder + "/Spare.txt", "");
+				writer.wait();
+			}
+			std::cout.rdbuf(previousOut);
+
+			Assert::IsTrue(std::filesystem::exists(folder + "/New.txt"));
+			Assert::IsTrue(readFile(folder + "/New.txt").empty());
+			Assert::IsTrue(readFile(folder + "/Spare.txt") == "Spare line\n");
+
+			std::filesystem::remove_all(folder);
+		}
+
+		TEST_METHOD(Markdown_Entities_Are_Not_Written)
+		{
+			namespace fs = std::filesystem;
+			CharacterList.ranks = { "Rank 0" };
+			GroupList.ranks = { "Rank 0" };
+
+			// Work in a folder of its own, with the entity directories a save writes into
+			fs::path previous = fs::current_path();
+			fs::remove_all("saveSkipTest");
+			fs::create_directories("saveSkipTest/Characters");
+			fs::create_directories("saveSkipTest/Units");
+			fs::current_path("saveSkipTest");
+
+			// One character and one unit from text files, one of each from a markdown file
+			character fromText, fromMarkdown;
+			fromText.name = symbol("Text Character");
+			fromText.source = symbol("Text Character.txt");
+			fromMarkdown.name = symbol("Markdown Character");
+			fromMarkdown.source = symbol("Roster.md");
+
+			unit textUnit, markdownUnit;
+			textUnit.name = symbol("Text Unit");
+			textUnit.source = symbol("Text Unit.txt");
+			markdownUnit.name = symbol("Markdown Unit");
+			markdownUnit.source = symbol("Roster.md");
+
+			{
+				saveWriter writer(2);
+				interactions::writeToFile({ fromText, fromMarkdown }, { textUnit, markdownUnit }, writer);
+				writer.wait();
+			}
+
+			// Expect only the text entities written, so the next load reads no entity twice
+			bool wroteText = fs::exists("Characters/Text Character.txt") && fs::exists("Units/Text Unit.txt");
+			bool wroteMarkdown = fs::exists("Characters/Markdown Character.txt") || fs::exists("Units/Markdown Unit.txt");
+
+			fs::current_path(previous);
+			fs::remove_all("saveSkipTest");
+
+			Assert::IsTrue(wroteText);
+			Assert::IsFalse(wroteMarkdown);
+		}
+	};
+}
+
+namespace NDJSON_Test
+{
+	TEST_CLASS(NDJSON_Export)
+	{
+	public:
+		// Read the export's lines, removing the file afterwards
+		static std::vector<std::string> readLines() {
+			std::vector<std::string> lines;
+			std::ifstream inFile("roster.ndjson", std::ios::binary);
+			std::string line;
+			while (getline(inFile, line))
+				lines.push_back(line);
+			inFile.close();
+
+			std::remove("roster.ndjson");
+			return lines;
+		}
+
+		TEST_METHOD(Escapes_And_Nulls)
+		{
+			CharacterList.ranks = { "Rank 0" };
+			GroupList.ranks = { "Rank 0" };
+
+			// A character in no unit, past the known ranks, with escaped text, tags and history
+			character chara;
+			chara.name = symbol("Char \"A\"");
+			chara.rank = 3;
+			chara.aspects.emplace_back("Tab\tand \\ slash");
+			chara.relations.push_back(makeRelation("Char B", "Line\nbreak \x01"));
+			chara.relations[0].tags.emplace_back("ally");
+			chara.historyIndex = 0;
+
+			unit uni;
+			uni.name = symbol("Unit A");
+			uni.member = symbol("Unit B");
+
+			std::vector<rosterString> history = { rosterString("First note\nSecond note\n") };
+			output::logListsNDJSON({ chara }, { uni }, history);
+			std::vector<std::string> lines = readLines();
+
+			Assert::AreEqual(size_t(2), lines.size());
+			Assert::AreEqual(std::string("{\"type\":\"character\",\"name\":\"Char \\\"A\\\"\",\"rank\":null,\"member\":null,"
+				"\"aspects\":[\"Tab\\tand \\\\ slash\"],"
+				"\"relations\":[{\"name\":\"Char B\",\"tags\":[\"ally\"],\"description\":\"Line\\nbreak \\u0001\"}],"
+				"\"history\":[\"First note\",\"Second note\"]}"), lines[0]);
+			Assert::AreEqual(std::string("{\"type\":\"unit\",\"name\":\"Unit A\",\"rank\":\"Rank 0\",\"member\":\"Unit B\",\"aspects\":[]}"), lines[1]);
+		}
+
+		TEST_METHOD(Empty_Roster_And_Empty_Fields)
+		{
+			CharacterList.ranks = { "Rank 0" };
+			GroupList.ranks = {};
+
+			// An empty roster writes an empty file
+			std::remove("roster.ndjson");
+			output::logListsNDJSON({}, {}, {});
+			Assert::IsTrue(std::filesystem::exists("roster.ndjson"));
+			Assert::IsTrue(readLines().empty());
+
+			// Empty text stays a string, empty lists stay arrays, and a history past the notes is empty
+			character chara;
+			chara.name = symbol("Char A");
+			chara.relations.push_back(makeRelation("Char B", ""));
+			chara.historyIndex = 4;
+
+			unit uni;
+			uni.name = symbol("Unit A");
+			uni.rank = -1;
+
+			output::logListsNDJSON({ chara }, { uni }, {});
+			std::vector<std::string> lines = readLines();
+
+			Assert::AreEqual(size_t(2), lines.size());
+			Assert::AreEqual(std::string("{\"type\":\"character\",\"name\":\"Char A\",\"rank\":\"Rank 0\",\"member\":null,\"aspects\":[],"
+				"\"relations\":[{\"name\":\"Char B\",\"tags\":[],\"description\":\"\"}],\"history\":[]}"), lines[0]);
+			Assert::AreEqual(std::string("{\"type\":\"unit\",\"name\":\"Unit A\",\"rank\":null,\"member\":null,\"aspects\":[]}"), lines[1]);
+		}
+
+		TEST_METHOD(One_Line_Per_Entity)
+		{
+			std::mt19937 rng(25);
+			CharacterList.ranks = { "Rank 0" };
+			GroupList.ranks = { "Rank 0" };
+
+			for (int roster = 0; roster < 200; roster++) {
+				std::vector<character> charList;
+				std::vector<unit> unitList;
+				randomRoster(rng, charList, unitList);
+
+				output::logListsNDJSON(charList, unitList, {});
+				std::vector<std::string> lines = readLines();
+
+				// Expect each entity's line in list order, characters first, its fields matching the entity
+				Assert::AreEqual(charList.size() + unitList.size(), lines.size());
+
+				for (int i = 0; i < lines.size(); i++) {
+					const entity& ent = i < charList.size() ? (const entity&)charList[i] : unitList[i - charList.size()];
+					std::string member = ent.member == symbol::none ? "null" : "\"" + ent.member.str() + "\"";
+					std::string prefix = std::string("{\"type\":\"") + (i < charList.size() ? "character" : "unit")
+						+ "\",\"name\":\"" + ent.name.str() + "\",\"rank\":\"Rank 0\",\"member\":" + member + ",";
+
+					Assert::IsTrue(lines[i].compare(0, prefix.size(), prefix) == 0);
+					Assert::IsTrue(lines[i].back() == '}');
+				}
+			}
+		}
+	};
+}
+
+namespace Image_Test
+{
+	TEST_CLASS(Roster_Image)
+	{
+	public:
+		// Write a file's contents
+		static void writeFile(const std::string& path, const std::string& contents) {
+			std::ofstream outFile(path, std::ios::binary);
+			outFile << contents;
+		}
+
+		// Expect two entities to hold the same fields
+		static void matchEntity(const entity& expected, const entity& actual) {
+			Assert::IsTrue(expected.name == actual.name && expected.member == actual.member && expected.source == actual.source);
+			Assert::AreEqual(expected.rank, actual.rank);
+			Assert::IsTrue(std::equal(expected.aspects.begin(), expected.aspects.end(), actual.aspects.begin(), actual.aspects.end()));
+		}
+
+		TEST_METHOD(Round_Trip_And_Staleness)
+		{
+			namespace fs = std::filesystem;
+
+			// Lay out a small roster in its own folder, a markdown file holding two characters
+			fs::path previous = fs::current_path();
+			fs::remove_all("imageTest");
+			fs::create_directories("imageTest/Characters");
+			fs::create_directories("imageTest/Units");
+			fs::current_path("imageTest");
+
+			writeFile("Characters/Char A.txt", "Rank: Rank 1\nMember: Unit A\nAspect: Brave\nRelation: Char B <ally, friend> knows them\nA history note\n");
+			writeFile("Characters/Pair.md", "# Char B\nRank: Rank 0\nRelation: Char A: rival\n# Char C\nMember: Unit B\nAnother note\n");
+			writeFile("Units/Unit A.txt", "Rank: Company\nMember: Unit B\nAspect: Loyal\n");
+			writeFile("Units/Unit B.txt", "Rank: Squad\n");
+
+			CharacterList.ranks = { "Rank 0", "Rank 1" };
+			GroupList.ranks = { "Squad", "Company" };
+
+			// Parse the files directly, noting the sources first as start up does
+			std::vector<rosterImage::sourceFile> sources = rosterImage::currentSources();
+			characterList parsedChars;
+			groupList parsedUnits;
+			input::loadCharFiles({ "Char A.txt", "Pair.md" }, parsedChars.entities(), parsedChars.other, 1);
+			input::loadUnitFiles({ "Unit A.txt", "Unit B.txt" }, parsedUnits.entities(), parsedChars.other, 1);
+			parsedChars.ranks = CharacterList.ranks;
+			parsedUnits.ranks = GroupList.ranks;
+			parsedChars.tags = { { "ally", "Fights alongside" } };
+
+			Assert::AreEqual(size_t(3), parsedChars.entities().size());
+			Assert::IsTrue(rosterImage::write(rosterImage::defaultPath, sources, parsedChars, parsedUnits));
+
+			// Map the image and copy it into fresh lists
+			{
+				rosterImage image;
+				Assert::IsTrue(image.open(rosterImage::defaultPath));
+
+				characterList loadedChars;
+				groupList loadedUnits;
+				image.load(loadedChars, loadedUnits);
+
+				// Expect the same roster as the direct parse
+				Assert::IsTrue(loadedChars.ranks == parsedChars.ranks && loadedUnits.ranks == parsedUnits.ranks);
+				Assert::IsTrue(loadedChars.tags == parsedChars.tags);
+				Assert::AreEqual(parsedChars.entities().size(), loadedChars.entities().size());
+				Assert::AreEqual(parsedUnits.entities().size(), loadedUnits.entities().size());
+
+				for (size_t i = 0; i < parsedChars.entities().size(); i++) {
+					const character& expected = parsedChars.entities()[i];
+					const character& actual = loadedChars.entities()[i];
+					matchEntity(expected, actual);
+
+					Assert::AreEqual(expected.relations.size(), actual.relations.size());
+					for (size_t j = 0; j < expected.relations.size(); j++) {
+						Assert::IsTrue(expected.relations[j].name == actual.relations[j].name);
+						Assert::IsTrue(expected.relations[j].desc == actual.relations[j].desc);
+						Assert::IsTrue(expected.relations[j].tags == actual.relations[j].tags);
+					}
+
+					Assert::AreEqual(expected.historyIndex == -1, actual.historyIndex == -1);
+					if (expected.historyIndex != -1)
+						Assert::IsTrue(parsedChars.other[expected.historyIndex] == loadedChars.other[actual.historyIndex]);
+				}
+
+				for (size_t i = 0; i < parsedUnits.entities().size(); i++)
+					matchEntity(parsedUnits.entities()[i], loadedUnits.entities()[i]);
+			}
+
+			// Touching a source file leaves the image out of date
+			writeFile("Units/Unit B.txt", "Rank: Company\n");
+			fs::last_write_time("Units/Unit B.txt", fs::last_write_time("Units/Unit B.txt") + std::chrono::seconds(5));
+
+			rosterImage stale;
+			Assert::IsFalse(stale.open(rosterImage::defaultPath));
+
+			// So does adding one, to an image that matched until then
+			rosterImage::write(rosterImage::defaultPath, rosterImage::currentSources(), parsedChars, parsedUnits);
+			Assert::IsTrue(stale.open(rosterImage::defaultPath));
+			writeFile("Units/Unit C.txt", "Rank: Squad\n");
+			Assert::IsFalse(stale.open(rosterImage::defaultPath));
+
+			fs::current_path(previous);
+			fs::remove_all("imageTest");
+		}
+	};
+}
+
+namespace Watch_Test
+{
+	TEST_CLASS(Incremental_Reload)
+	{
+	public:
+		// Drop a removed position from a list of positions
+		static std::vector<int> without(std::vector<int> positions, int removed) {
+			positions.erase(std::remove(positions.begin(), positions.end(), removed), positions.end());
+			return positions;
+		}
+
+		TEST_METHOD(Appends_And_Removals_Match_Rebuild)
+		{
+			std::mt19937 rng(5);
+
+			for (int roster = 0; roster < 500; roster++) {
+				std::vector<character> charList;
+				std::vector<unit> unitList;
+				randomRoster(rng, charList, unitList);
+
+				for (character& chara : charList) {
+					chara.rank = rng() % 4;
+					for (entity::tagFeature& relation : chara.relations)
+						relation.tags.emplace_back("tag " + std::to_string(rng() % 3));
+				}
+
+				if (charList.empty())
+					continue;
+
+				// Index all but the last character, then append it as a reload adds a new file's entity
+				int last = charList.size() - 1;
+				std::vector<character> before(charList.begin(), charList.end() - 1);
+
+				unitAncestors tree;
+				tree.build(unitList);
+
+				unitHierarchy hierarchy;
+				unitSizes sizes;
+				rankIndex ranks;
+				tagIndex tags;
+				hierarchy.build(before);
+				sizes.build(before, tree);
+				ranks.build(before, unitList);
+				tags.build(before);
+
+				hierarchy.addCharacter(last, charList[last].member);
+				sizes.addCharacter(tree, last, charList[last].member);
+				ranks.addCharacter(last, charList[last].rank);
+				tags.insert(charList, last);
+
+				// Remove a character as a reload drops it, leaving its position behind
+				int removed = rng() % charList.size();
+				hierarchy.removeCharacter(removed, charList[removed].member);
+				sizes.removeCharacter(tree, charList[removed].member);
+				ranks.removeCharacter(removed);
+				tags.remove(removed);
+
+				// Expect what a rebuild holds, less the removed character
+				unitHierarchy freshHierarchy;
+				rankIndex freshRanks;
+				tagIndex freshTags;
+				freshHierarchy.build(charList);
+				freshRanks.build(charList, unitList);
+				freshTags.build(charList);
+
+				Assert::IsTrue(hierarchy.current(charList.size()));
+				Assert::IsTrue(tags.current(charList.size()));
+
+				std::unordered_set<symbol> members = { symbol::none };
+				for (const character& chara : charList)
+					members.insert(chara.member);
+
+				for (const symbol& member : members)
+					Assert::IsTrue(hierarchy.characters(member) == without(freshHierarchy.characters(member), removed));
+
+				for (int rank = 0; rank < freshRanks.characterRanks(); rank++)
+					Assert::IsTrue(ranks.characters(rank) == without(freshRanks.characters(rank), removed));
+
+				for (const symbol& tag : freshTags.tags()) {
+					std::vector<int> expected, actual;
+					for (const tagIndex::posting& post : freshTags.tagged(tag))
+						expected.push_back(post.source);
+					for (const tagIndex::posting& post : tags.tagged(tag))
+						actual.push_back(post.source);
+
+					Assert::IsTrue(actual == without(expected, removed));
+				}
+
+				// Sizes count as if the removed character belonged to no unit
+				std::vector<character> remaining = charList;
+				remaining[removed].member = symbol::none;
+				unitSizes freshSizes;
+				freshSizes.build(remaining, tree);
+
+				for (size_t i = 0; i < unitList.size(); i++) {
+					Assert::AreEqual(freshSizes.direct(i), sizes.direct(i));
+					Assert::AreEqual(freshSizes.total(i), sizes.total(i));
+				}
+			}
+		}
+	};
+}
+
+namespace Hierarchy_Test
+{
+	TEST_CLASS(Unit_Hierarchy)
+	{
+	public:
+		TEST_METHOD(Roots_Children_And_Members)
+		{
+			// Two trees, a unit under a missing unit, and characters spread across them
+			std::vector<unit> unitList(6);
+			const char* names[] = { "Tree A", "Tree B", "Under A 1", "Under B", "Under A 2", "Orphan" };
+			const char* members[] = { "None", "None", "Tree A", "Tree B", "Tree A", "Missing" };
+			for (int i = 0; i < 6; i++) {
+				unitList[i].name = symbol(names[i]);
+				unitList[i].member = symbol(members[i]);
+			}
+
+			std::vector<character> charList(5);
+			const char* charMembers[] = { "Under A 2", "Tree A", "None", "Under A 2", "Missing" };
+			for (int i = 0; i < 5; i++) {
+				charList[i].name = symbol("Hierarchy Character " + std::to_string(i));
+				charList[i].member = symbol(charMembers[i]);
+			}
+
+			unitAncestors tree;
+			tree.build(unitList);
+			unitHierarchy hierarchy;
+			hierarchy.build(charList);
+
+			// Expect the parentless units as roots, each unit's children in list order
+			std::vector<int> roots;
+			for (int i = 0; i < 6; i++)
+				if (tree.parent(i) == -1)
+					roots.push_back(i);
+
+			Assert::IsTrue(roots == std::vector<int>({ 0, 1, 5 }));
+			Assert::IsTrue(std::vector<int>(tree.children(0).begin(), tree.children(0).end()) == std::vector<int>({ 2, 4 }));
+			Assert::IsTrue(std::vector<int>(tree.children(1).begin(), tree.children(1).end()) == std::vector<int>({ 3 }));
+			Assert::AreEqual(size_t(0), tree.children(5).size());
+
+			// Expect each unit's characters in list order, characters of no unit or a missing unit filed under that name
+			Assert::IsTrue(hierarchy.characters(symbol("Under A 2")) == std::vector<int>({ 0, 3 }));
+			Assert::IsTrue(hierarchy.characters(symbol("Tree A")) == std::vector<int>({ 1 }));
+			Assert::IsTrue(hierarchy.characters(symbol::none) == std::vector<int>({ 2 }));
+			Assert::IsTrue(hierarchy.characters(symbol("Missing")) == std::vector<int>({ 4 }));
+			Assert::IsTrue(hierarchy.characters(symbol("Tree B")).empty());
+
+			// Moving a character keeps both member lists in list order
+			charList[3].member = symbol("Tree A");
+			hierarchy.moveCharacter(3, symbol("Under A 2"), symbol("Tree A"));
+			charList[1].member = symbol("Under A 2");
+			hierarchy.moveCharacter(1, symbol("Tree A"), symbol("Under A 2"));
+
+			Assert::IsTrue(hierarchy.characters(symbol("Under A 2")) == std::vector<int>({ 0, 1 }));
+			Assert::IsTrue(hierarchy.characters(symbol("Tree A")) == std::vector<int>({ 3 }));
+			Assert::IsTrue(hierarchy.current(charList.size()));
+		}
+	};
+}
+
+namespace Ancestor_Test
+{
+	TEST_CLASS(Unit_Ancestors)
+	{
+	public:
+		// Build a unit belonging to another
+		static unit makeUnit(const std::string& name, const std::string& member) {
+			unit uni;
+			uni.name = symbol(name);
+			uni.member = member.empty() ? symbol::none : symbol(member);
+			return uni;
+		}
+
+		TEST_METHOD(Cycles_Cut_Depths_And_Ancestry)
+		{
+			// A chain, a two unit cycle with a unit hanging off it, and a unit belonging to itself
+			std::vector<unit> unitList = {
+				makeUnit("Root", ""), makeUnit("Mid", "Root"), makeUnit("Leaf", "Mid"),
+				makeUnit("Cycle A", "Cycle B"), makeUnit("Cycle B", "Cycle A"), makeUnit("Hanger", "Cycle A"),
+				makeUnit("Self", "Self")
+			};
+
+			unitAncestors tree;
+			tree.build(unitList);
+
+			// Expect each cycle cut at its first unit in the list
+			Assert::AreEqual(size_t(2), tree.cycles().size());
+			Assert::IsTrue(tree.cycles()[0] == std::vector<int>({ 3, 4 }));
+			Assert::IsTrue(tree.cycles()[1] == std::vector<int>({ 6 }));
+			Assert::AreEqual(-1, tree.parent(3));
+			Assert::AreEqual(3, tree.parent(4));
+			Assert::AreEqual(-1, tree.parent(6));
+
+			// Expect depths and ancestors to follow the cut links
+			Assert::AreEqual(0, tree.depth(0));
+			Assert::AreEqual(2, tree.depth(2));
+			Assert::AreEqual(1, tree.depth(4));
+			Assert::AreEqual(1, tree.depth(5));
+			Assert::IsTrue(tree.ancestors(2) == std::vector<int>({ 1, 0 }));
+			Assert::IsTrue(tree.ancestors(4) == std::vector<int>({ 3 }));
+			Assert::IsTrue(tree.ancestors(6).empty());
+
+			// Expect isUnder to hold only downwards, never for a unit and itself
+			Assert::IsTrue(tree.isUnder(2, 0));
+			Assert::IsTrue(tree.isUnder(2, 1));
+			Assert::IsFalse(tree.isUnder(0, 2));
+			Assert::IsFalse(tree.isUnder(0, 0));
+			Assert::IsTrue(tree.isUnder(4, 3));
+			Assert::IsFalse(tree.isUnder(3, 4));
+			Assert::IsFalse(tree.isUnder(5, 4));
+			Assert::IsFalse(tree.isUnder(6, 6));
+
+			// Every unit appears once in preorder
+			std::vector<int> order = tree.preorder();
+			std::sort(order.begin(), order.end());
+			Assert::IsTrue(order == std::vector<int>({ 0, 1, 2, 3, 4, 5, 6 }));
+		}
+
+		TEST_METHOD(Full_Print_Starts_Every_Parentless_Unit)
+		{
+			GroupList.ranks = { "Rank 0" };
+			CharacterList.ranks = { "Rank 0" };
+
+			// A plain tree, a unit under a missing unit and a two unit cycle
+			std::vector<character> charList;
+			std::vector<unit> unitList = {
+				makeUnit("Top", ""), makeUnit("Under Top", "Top"),
+				makeUnit("Orphan", "Missing"),
+				makeUnit("Loop A", "Loop B"), makeUnit("Loop B", "Loop A")
+			};
+
+			// Capture the print
+			std::ostringstream captured;
+			std::streambuf* previous = std::cout.rdbuf(captured.rdbuf());
+			output::printFullUnit(charList, unitList);
+			std::cout.rdbuf(previous);
+
+			// Expect every unit exactly once, the cycle from the unit whose link was cut
+			std::string printed = captured.str();
+			for (std::string name : { "Top", "Under Top", "Orphan", "Loop A", "Loop B" }) {
+				size_t first = printed.find("] " + name + " (");
+				Assert::IsTrue(first != std::string::npos);
+				Assert::IsTrue(printed.find("] " + name + " (", first + 1) == std::string::npos);
+			}
+
+			Assert::IsTrue(printed.find("\n[Rank 0] Orphan (") != std::string::npos);
+			Assert::IsTrue(printed.find("\n[Rank 0] Loop A (") != std::string::npos);
+			Assert::IsTrue(printed.find("    [Rank 0] Loop B (") != std::string::npos);
+		}
+	};
+}
+
+namespace Load_Test
+{
+	TEST_CLASS(Parallel_Load)
+	{
+	public:
+		// Write a whole file
+		static void writeFile(const std::string& path, const std::string& content) {
+			std::ofstream outFile(path, std::ios::binary);
+			outFile << content;
+		}
+
+		TEST_METHOD(Threads_Match_One_Thread)
+		{
+			namespace fs = std::filesystem;
+			CharacterList.ranks = { "Rank 0", "Rank 1" };
+
+			// Lay out characters in text and markdown files, with a file that fails to load among them
+			fs::path previous = fs::current_path();
+			fs::remove_all("loadTest");
+			fs::create_directories("loadTest/Characters");
+			fs::current_path("loadTest");
+
+			std::vector<std::string> files;
+			for (int i = 0; i < 40; i++) {
+				std::string name = "Char " + std::to_string(i);
+				if (i % 10 == 5) {
+					files.push_back("Group " + std::to_string(i) + ".md");
+					writeFile("Characters/" + files.back(), "# " + name + "\nRank: Rank 1\nA note\n# " + name + " Twin\nRelation: " + name + ": twin\n");
+				}
+				else {
+					files.push_back(name + ".txt");
+					writeFile("Characters/" + files.back(), "Rank: Rank " + std::to_string(i % 2) + "\nMember: Unit " + std::to_string(i % 3)
+						+ "\nRelation: Char " + std::to_string(i + 1) + " <tag " + std::to_string(i % 4) + "> knows\n" + (i % 3 == 0 ? "History of " + name + "\n" : ""));
+				}
+
+				if (i == 20) {
+					files.push_back("NoExtension");
+					writeFile("Characters/NoExtension", "Rank: Rank 1\n");
+				}
+			}
+
+			// Load on one thread, then on four
+			std::vector<character> serial, threaded;
+			std::vector<rosterString> serialHistory, threadedHistory;
+			input::loadCharFiles(files, serial, serialHistory, 1);
+			input::loadCharFiles(files, threaded, threadedHistory, 4);
+
+			fs::current_path(previous);
+			fs::remove_all("loadTest");
+
+			// Expect the same characters in file order, the failed file skipped by both
+			Assert::AreEqual(size_t(44), serial.size());
+			Assert::AreEqual(serial.size(), threaded.size());
+			Assert::AreEqual(serialHistory.size(), threadedHistory.size());
+
+			for (size_t i = 0; i < serial.size(); i++) {
+				Assert::IsTrue(serial[i].name == threaded[i].name && serial[i].source == threaded[i].source);
+				Assert::IsTrue(serial[i].member == threaded[i].member);
+				Assert::AreEqual(serial[i].rank, threaded[i].rank);
+				Assert::AreEqual(serial[i].relations.size(), threaded[i].relations.size());
+
+				for (size_t j = 0; j < serial[i].relations.size(); j++) {
+					Assert::IsTrue(serial[i].relations[j].name == threaded[i].relations[j].name);
+					Assert::IsTrue(serial[i].relations[j].tags == threaded[i].relations[j].tags);
+				}
+
+				Assert::AreEqual(serial[i].historyIndex == -1, threaded[i].historyIndex == -1);
+				if (serial[i].historyIndex != -1)
+					Assert::IsTrue(serialHistory[serial[i].historyIndex] == threadedHistory[threaded[i].historyIndex]);
+			}
+		}
+	};
+}
+
+namespace Symbol_Test
+{
+	TEST_CLASS(Symbol_Table)
+	{
+	public:
+		TEST_METHOD(Interning_Round_Trip)
+		{
+			// "None" and the default symbol are the same sentinel
+			Assert::IsTrue(symbol("None") == symbol::none);
+			Assert::IsTrue(symbol() == symbol::none);
+			Assert::AreEqual(std::string("None"), symbol::none.str());
+
+			// Intern past a block of the table, with an empty text and one holding a zero byte among them
+			std::vector<std::string> texts = { "", std::string("Zero\0Byte", 9), "Trailing space " };
+			for (int i = 0; i < 5000; i++)
+				texts.push_back("Symbol Test " + std::to_string(i));
+
+			std::vector<symbol> symbols;
+			for (const std::string& text : texts)
+				symbols.emplace_back(text);
+
+			// Expect each text back, and the same id however the text is passed in
+			for (size_t i = 0; i < texts.size(); i++) {
+				Assert::IsTrue(symbols[i].str() == texts[i]);
+				Assert::IsTrue(symbol(std::string_view(texts[i])) == symbols[i]);
+				Assert::IsTrue(symbol(std::string(texts[i])) == symbols[i]);
+			}
+
+			Assert::IsTrue(symbol("Symbol Test 7") == symbols[10]);
+			Assert::IsTrue(symbols[3] != symbols[4]);
+
+			// Threads interning the same new texts agree on every id
+			std::vector<std::vector<symbol>> found(4);
+			std::vector<std::thread> workers;
+			for (int t = 0; t < 4; t++)
+				workers.emplace_back([&found, t]() {
+					for (int i = 0; i < 2000; i++)
+						found[t].emplace_back("Shared Symbol " + std::to_string(i));
+				});
+			for (std::thread& worker : workers)
+				worker.join();
+
+			for (int t = 1; t < 4; t++)
+				Assert::IsTrue(found[t] == found[0]);
+			for (int i = 0; i < 2000; i++)
+				Assert::AreEqual("Shared Symbol " + std::to_string(i), found[0][i].str());
+		}
+	};
+}
+
+namespace Reader_Test
+{
+	TEST_CLASS(Line_Reader)
+	{
+	public:
+		TEST_METHOD(Chunk_Boundaries_And_Line_Endings)
+		{
+			// Empty lines, Windows line endings, a line longer than any chunk below and no final newline
+			const std::string content = "First\r\n\nSecond line\r\n\r\n" + std::string(40, 'x') + "\nLone \r in the middle\nLast";
+			const std::vector<std::string> expected = { "First", "", "Second line", "", std::string(40, 'x'), "Lone \r in the middle", "Last" };
+
+			const std::string path = "lineReaderTest.txt";
+			{
+				std::ofstream outFile(path, std::ios::binary);
+				outFile << content;
+			}
+
+			// Expect the same lines from every chunk size, as lines straddle the chunk ends
+			for (size_t chunkSize = 1; chunkSize <= content.size() + 1; chunkSize++) {
+				support::lineReader reader(path, chunkSize);
+				std::vector<std::string> lines;
+				std::string_view line;
+
+				while (reader.next(line))
+					lines.emplace_back(line);
+
+				Assert::IsTrue(lines == expected);
+				Assert::AreEqual(uint64_t(content.size()), reader.size());
+				Assert::AreEqual(uint64_t(content.size()), reader.consumed());
+			}
+
+			std::remove(path.c_str());
+
+			// A missing file reads as empty
+			support::lineReader missing("lineReaderMissing.txt", 8);
+			std::string_view line;
+			Assert::IsFalse(missing.next(line));
+		}
+	};
+}
+
+namespace Recheck_Test
+{
+	TEST_CLASS(Incremental_Recheck)
+	{
+	public:
+		// Sort a list of diagnostics into a comparable order
+		static std::vector<std::tuple<int, uint32_t, bool, uint32_t>> sorted(const std::vector<diagnostic>& diagnostics) {
+			std::vector<std::tuple<int, uint32_t, bool, uint32_t>> keys;
+			for (const diagnostic& diag : diagnostics)
+				keys.emplace_back(diag.problem, diag.entity.id(), diag.unitEntity, diag.value.id());
+
+			std::sort(keys.begin(), keys.end());
+			return keys;
+		}
+
+		TEST_METHOD(Recheck_Matches_Rebuild)
+		{
+			std::mt19937 rng(13);
+			auto randomName = [&](const std::string& prefix, int pool) { return symbol(prefix + std::to_string(rng() % pool)); };
+
+			// A roster large enough that single edits are rechecked rather than rebuilt
+			characterList chars;
+			groupList groups;
+
+			for (int i = 0; i < 300; i++) {
+				character chara;
+				chara.name = symbol("Recheck Character " + std::to_string(i));
+				chara.member = rng() % 4 == 0 ? symbol::none : randomName("Recheck Unit ", 60);
+				for (int j = rng() % 3; j > 0; j--)
+					chara.relations.push_back(makeRelation(randomName("Recheck Character ", 320).str(), "Test"));
+				chars.add(chara);
+			}
+
+			for (int i = 0; i < 50; i++) {
+				unit uni;
+				uni.name = symbol("Recheck Unit " + std::to_string(i));
+				uni.member = rng() % 3 == 0 ? symbol::none : randomName("Recheck Unit ", 60);
+				groups.add(uni);
+			}
+
+			validationCache cache;
+			cache.check(chars, groups);
+
+			for (int edit = 0; edit < 400; edit++) {
+				std::vector<character>& charList = chars.entities();
+				int pos = rng() % charList.size();
+
+				// Edit a membership, a relation, or add or remove an entity, noting the name it touched
+				switch (rng() % 5) {
+				case 0:
+					if (!chars.removed(pos)) {
+						charList[pos].member = randomName("Recheck Unit ", 60);
+						cache.markDirty(charList[pos].name);
+					}
+					break;
+				case 1:
+					if (!chars.removed(pos)) {
+						charList[pos].relations.push_back(makeRelation(randomName("Recheck Character ", 320).str(), "Test"));
+						cache.markDirty(charList[pos].name);
+					}
+					break;
+				case 2:
+					if (!chars.removed(pos)) {
+						cache.markDirty(charList[pos].name);
+						chars.remove(chars.at(pos));
+					}
+					break;
+				case 3: {
+					// Possibly repeating an existing name
+					character chara;
+					chara.name = randomName("Recheck Character ", 320);
+					chara.member = randomName("Recheck Unit ", 60);
+					chars.add(chara);
+					cache.markDirty(chara.name);
+					break;
+				}
+				case 4: {
+					int unitPos = rng() % groups.entities().size();
+					if (!groups.removed(unitPos)) {
+						cache.markDirty(groups.entities()[unitPos].name);
+						groups.remove(groups.at(unitPos));
+					}
+					break;
+				}
+				}
+
+				// Expect the recheck to find what validating everything again finds
+				validationCache fresh;
+				Assert::IsTrue(sorted(cache.check(chars, groups)) == sorted(fresh.check(chars, groups)));
+			}
+		}
+	};
+}
+
+namespace Sizes_Test
+{
+	TEST_CLASS(Unit_Sizes)
+	{
+	public:
+		TEST_METHOD(Moves_Match_Rebuild)
+		{
+			std::mt19937 rng(16);
+
+			for (int roster = 0; roster < 500; roster++) {
+				std::vector<character> charList;
+				std::vector<unit> unitList;
+				randomRoster(rng, charList, unitList);
+
+				if (charList.empty() || unitList.empty())
+					continue;
+
+				unitAncestors tree;
+				tree.build(unitList);
+				unitSizes sizes;
+				sizes.build(charList, tree);
+
+				// Move characters between units, to no unit and to missing units
+				for (int move = 0; move < 10; move++) {
+					character& chara = charList[rng() % charList.size()];
+					symbol from = chara.member;
+					int pick = rng() % (unitList.size() + 2);
+
+					if (size_t(pick) < unitList.size())
+						chara.member = unitList[pick].name;
+					else
+						chara.member = pick == int(unitList.size()) ? symbol::none : symbol("Sizes Missing");
+
+					sizes.moveCharacter(tree, from, chara.member);
+				}
+
+				// Expect the counts a bottom-up rebuild gives, totals summing every unit below
+				unitSizes fresh;
+				fresh.build(charList, tree);
+
+				for (size_t i = 0; i < unitList.size(); i++) {
+					Assert::AreEqual(fresh.direct(i), sizes.direct(i));
+					Assert::AreEqual(fresh.total(i), sizes.total(i));
+
+					int total = fresh.direct(i);
+					for (int child : tree.children(i))
+						total += fresh.total(child);
+					Assert::AreEqual(total, fresh.total(i));
+				}
+			}
+		}
+	};
+}
+
+namespace Refactor_Test
+{
+	TEST_CLASS(Batch_Refactor)
+	{
+	public:
+		// Fill the stores with references to missing characters and units
+		static void fill(characterList& chars, groupList& groups) {
+			const char* charMembers[] = { "Lost Unit", "Gone Unit", "Split Unit", "Split Unit", "Unit 0" };
+			for (int i = 0; i < 5; i++) {
+				character chara;
+				chara.name = symbol("Char " + std::to_string(i));
+				chara.member = symbol(charMembers[i]);
+				chars.add(chara);
+			}
+
+			chars.entities()[0].relations.push_back(makeRelation("Lost Char", "Friend"));
+			chars.entities()[1].relations.push_back(makeRelation("Gone Char", "Rival"));
+			chars.entities()[1].relations.push_back(makeRelation("Char 0", "Sibling"));
+			chars.entities()[3].relations.push_back(makeRelation("Lost Char", "Mentor"));
+
+			const char* unitMembers[] = { "None", "Lost Unit", "Split Unit", "Gone Unit" };
+			for (int i = 0; i < 4; i++) {
+				unit uni;
+				uni.name = symbol("Unit " + std::to_string(i));
+				uni.member = symbol(unitMembers[i]);
+				groups.add(uni);
+			}
+		}
+
+		TEST_METHOD(Batch_Matches_Prompts)
+		{
+			CharacterList.ranks = { "Rank 0" };
+			GroupList.ranks = { "Rank 0" };
+
+			// Resolve each missing entity through the prompts
+			characterList promptChars;
+			groupList promptGroups;
+			fill(promptChars, promptGroups);
+
+			// Rename Lost Unit to Unit 1, delete Gone Unit, split Split Unit, rename Lost Char to Char 2, delete Gone Char
+			std::istringstream answers("1\n2\n" "2\n" "3\n1\n4\n3\n" "1\n3\n" "2\n");
+			std::streambuf* previousIn = std::cin.rdbuf(answers.rdbuf());
+
+			missingEntity::refacUnit(symbol("Lost Unit"), promptChars, promptGroups);
+			missingEntity::refacUnit(symbol("Gone Unit"), promptChars, promptGroups);
+			missingEntity::refacUnit(symbol("Split Unit"), promptChars, promptGroups);
+			missingEntity::refacChar(symbol("Lost Char"), promptChars);
+			missingEntity::refacChar(symbol("Gone Char"), promptChars);
+			simpleFind::compact(promptChars);
+			simpleFind::compact(promptGroups);
+
+			std::cin.rdbuf(previousIn);
+
+			// Resolve the same through a refactor document
+			characterList batchChars;
+			groupList batchGroups;
+			fill(batchChars, batchGroups);
+
+			{
+				std::ofstream document("refactorTest.txt");
+				document << "Rename Unit: Lost Unit: Unit 1\nDelete Unit: Gone Unit\n"
+					<< "Split Unit: Split Unit: Char 2: Unit 0\nSplit Unit: Split Unit: Char 3: Unit 3\nSplit Unit: Split Unit: Unit 2: Unit 2\n"
+					<< "Rename Character: Lost Char: Char 2\nDelete Character: Gone Char\n";
+			}
+
+			missingEntity::refacBatch("refactorTest.txt", batchChars, batchGroups);
+			std::remove("refactorTest.txt");
+
+			// Expect the same lists either way
+			Assert::AreEqual(promptChars.entities().size(), batchChars.entities().size());
+			Assert::AreEqual(promptGroups.entities().size(), batchGroups.entities().size());
+
+			for (size_t i = 0; i < batchChars.entities().size(); i++) {
+				const character& expected = promptChars.entities()[i];
+				const character& actual = batchChars.entities()[i];
+
+				Assert::IsTrue(expected.name == actual.name && expected.member == actual.member);
+				Assert::AreEqual(expected.relations.size(), actual.relations.size());
+				for (size_t j = 0; j < expected.relations.size(); j++)
+					Assert::IsTrue(expected.relations[j].name == actual.relations[j].name);
+			}
+
+			for (size_t i = 0; i < batchGroups.entities().size(); i++)
+				Assert::IsTrue(promptGroups.entities()[i].member == batchGroups.entities()[i].member);
+
+			// And the expected resolution
+			Assert::IsTrue(batchChars.entities()[0].member == symbol("Unit 1"));
+			Assert::IsTrue(batchChars.entities()[1].member == symbol::none);
+			Assert::IsTrue(batchChars.entities()[2].member == symbol("Unit 0"));
+			Assert::IsTrue(batchChars.entities()[3].member == symbol("Unit 3"));
+			Assert::IsTrue(batchChars.entities()[0].relations[0].name == symbol("Char 2"));
+			Assert::AreEqual(size_t(1), batchChars.entities()[1].relations.size());
+			Assert::IsTrue(batchGroups.entities()[2].member == symbol::none);
 		}
 	};
 }